@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "header.h"
+
+// Library interface : wraps IntExt values and operations, reporting errors through contexts
+
+#define ERROR_MESSAGE_SIZE 128
+
+struct BigCalcContext {
+    char errorMessage[ERROR_MESSAGE_SIZE];  // message of last error, empty if last call succeeded
+    double maxBits;                         // 0 : no limit
+    int jobs;                               // threads used by BigCalcEvaluate
+};
+
+struct BigCalcValue {
+    IntExt value;
+};
+
+static int SetError(BigCalcContext *context, int error, const char *message);
+static int CreateValue(BigCalcContext *context, IntExt value, BigCalcValue **result);
+static int ComputeOperation(BigCalcContext *context, char operator, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+
+
+// Return new context, to be freed with BigCalcFreeContext
+BigCalcContext *BigCalcCreateContext() {
+    BigCalcContext *result = malloc(sizeof(BigCalcContext));
+    if (result == NULL) {
+        return NULL;
+    }
+
+    result->errorMessage[0] = '\0';
+    result->maxBits = 0;
+    result->jobs = 1;
+
+    return result;
+}
+
+void BigCalcFreeContext(BigCalcContext *context) {
+    free(context);
+}
+
+// Return message of last error in context, empty string if last call succeeded
+const char *BigCalcGetError(BigCalcContext *context) {
+    return context->errorMessage;
+}
+
+// Make BigCalcEvaluate fail with BIGCALC_ERROR_TOO_LARGE when a value of expression is estimated
+// to have (maxBits) bits or more. 0 removes the limit
+void BigCalcSetMaxBits(BigCalcContext *context, double maxBits) {
+    context->maxBits = maxBits;
+}
+
+// Make BigCalcEvaluate compute independent subexpressions with up to (jobs) threads. Default is 1
+void BigCalcSetJobs(BigCalcContext *context, int jobs) {
+    context->jobs = jobs < 1 ? 1 : jobs;
+}
+
+int BigCalcFromInt(BigCalcContext *context, int64_t value, BigCalcValue **result) {
+    uint64_t absoluteValue = value < 0 ? -(uint64_t) value : (uint64_t) value;
+
+    IntExt intExt = BcInitiateIntExt(0, value < 0);
+    BcSetSmallValue(&intExt, absoluteValue);
+
+    return CreateValue(context, intExt, result);
+}
+
+// Read decimal number, optionally preceded by - or ~
+int BigCalcFromString(BigCalcContext *context, const char *decimal, BigCalcValue **result) {
+    int negative = decimal[0] == '-' || decimal[0] == '~';
+    const char *digits = decimal + negative;
+
+    size_t length = strspn(digits, "0123456789");
+    if (length == 0 || digits[length] != '\0' || length > INT32_MAX) {
+        return SetError(context, BIGCALC_ERROR_PARSING, "invalid number");
+    }
+
+    IntExt intExt = BcReadDecimal((char *) digits, (int) length);
+    intExt.negative = negative;
+    BcRemoveHeadZeros(&intExt);
+
+    return CreateValue(context, intExt, result);
+}
+
+void BigCalcFreeValue(BigCalcValue *value) {
+    if (value != NULL) {
+        BcFreeIntExt(value->value);
+        free(value);
+    }
+}
+
+int BigCalcAdd(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '+', a, b, result);
+}
+
+int BigCalcSub(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '-', a, b, result);
+}
+
+int BigCalcMultiply(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '*', a, b, result);
+}
+
+int BigCalcDivide(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '/', a, b, result);
+}
+
+int BigCalcModulo(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '%', a, b, result);
+}
+
+int BigCalcExponent(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '^', a, b, result);
+}
+
+// Compute (a^b)%m without computing a^b
+int BigCalcPowerModulo(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, const BigCalcValue *m, BigCalcValue **result) {
+    IntExt base = BcDuplicateIntExt(a->value);
+
+    int error = BcPowerModulo(&base, b->value, m->value);
+    if (error != BIGCALC_OK) {
+        BcFreeIntExt(base);
+        return SetError(context, error, NULL);
+    }
+
+    return CreateValue(context, base, result);
+}
+
+int BigCalcShiftLeft(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '<', a, b, result);
+}
+
+int BigCalcShiftRight(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    return ComputeOperation(context, '>', a, b, result);
+}
+
+// Parse and compute expression, with the same syntax as calculate program
+int BigCalcEvaluate(BigCalcContext *context, const char *expression, BigCalcValue **result) {
+    Rpn rpn;
+    const char *parsingMessage;
+
+    // number tokens point to expression, which is only read
+    uint64_t profileStart = BcProfileStart();
+    int error = BcParseRpn((char *) expression, strlen(expression), &rpn, &parsingMessage);
+    if (error != BIGCALC_OK) {
+        return SetError(context, error, parsingMessage);
+    }
+    BcProfileStop(PROFILE_PARSE, profileStart, rpn.length);
+
+    if (context->maxBits > 0 && !(BcEstimateRpn(rpn).maxBits < context->maxBits)) {
+        BcFreeRpn(rpn);
+        return SetError(context, BIGCALC_ERROR_TOO_LARGE, NULL);
+    }
+
+    IntExt value;
+    error = BcEvaluateRpnParallel(rpn, context->jobs, &value);
+    BcFreeRpn(rpn);
+    if (error != BIGCALC_OK) {
+        return SetError(context, error, NULL);
+    }
+
+    return CreateValue(context, value, result);
+}
+
+// Return decimal notation of value, to be freed with BigCalcFreeString
+int BigCalcFormat(BigCalcContext *context, const BigCalcValue *value, char **result) {
+    *result = BcFormatDecimal(value->value);
+    if (*result == NULL) {
+        return SetError(context, BIGCALC_ERROR_OUT_OF_MEMORY, NULL);
+    }
+
+    return SetError(context, BIGCALC_OK, NULL);
+}
+
+void BigCalcFreeString(char *string) {
+    free(string);
+}
+
+// Store error message in context and return error code
+// message = NULL : use default message of error code
+static int SetError(BigCalcContext *context, int error, const char *message) {
+    if (error == BIGCALC_OK) {
+        context->errorMessage[0] = '\0';
+    } else {
+        snprintf(context->errorMessage, ERROR_MESSAGE_SIZE, "%s", message != NULL ? message : BcGetErrorMessage(error));
+    }
+
+    return error;
+}
+
+// Store in result a new library value owning intExt and return status
+// value is freed when the library value can't be allocated
+static int CreateValue(BigCalcContext *context, IntExt value, BigCalcValue **result) {
+    *result = malloc(sizeof(BigCalcValue));
+    if (*result == NULL) {
+        BcFreeIntExt(value);
+        return SetError(context, BIGCALC_ERROR_OUT_OF_MEMORY, NULL);
+    }
+
+    (*result)->value = value;
+
+    return SetError(context, BIGCALC_OK, NULL);
+}
+
+// Compute (a) (operator) (b) into a new value, operands being left unchanged
+static int ComputeOperation(BigCalcContext *context, char operator, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result) {
+    IntExt base = BcDuplicateIntExt(a->value);
+
+    int error = BcApplyOperator(operator, &base, b->value);
+    if (error != BIGCALC_OK) {
+        BcFreeIntExt(base);
+        return SetError(context, error, NULL);
+    }
+
+    return CreateValue(context, base, result);
+}
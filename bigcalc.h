@@ -0,0 +1,66 @@
+#ifndef BIGCALC_H
+#define BIGCALC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Big int expression calculator library
+//
+// Every function works on a context, created with BigCalcCreateContext. A context keeps the message
+// of the last error and evaluation options. Contexts are independent : each thread should use its own
+// context, while values can be shared between threads as they are never modified once created.
+// Caches shared by all contexts (powers of ten, mapped storage) are protected by locks.
+//
+// Functions that can fail return a status code, BIGCALC_OK on success, and store their result in
+// their last argument. Results must be freed with BigCalcFreeValue or BigCalcFreeString.
+// Values and strings that can't be allocated are reported with BIGCALC_ERROR_OUT_OF_MEMORY. Digit arrays
+// allocated during computations can't be reported : the process is aborted, without writing anything.
+
+// Status codes
+enum BigCalcStatus {
+    BIGCALC_OK = 0,
+    BIGCALC_ERROR_PARSING,              // invalid expression or number
+    BIGCALC_ERROR_DIVISION_BY_ZERO,
+    BIGCALC_ERROR_EXPONENT_RANGE,       // exponent over 2^32 - 1 (except for power modulo)
+    BIGCALC_ERROR_NEGATIVE_EXPONENT,
+    BIGCALC_ERROR_SHIFT_RANGE,          // shift over 2^32 - 1
+    BIGCALC_ERROR_NEGATIVE_SHIFT,
+    BIGCALC_ERROR_TOO_LARGE,            // estimated size over context limit
+    BIGCALC_ERROR_OUT_OF_MEMORY         // result value or string can't be allocated
+};
+
+typedef struct BigCalcContext BigCalcContext;
+typedef struct BigCalcValue BigCalcValue;
+
+BigCalcContext *BigCalcCreateContext();
+void BigCalcFreeContext(BigCalcContext *context);
+const char *BigCalcGetError(BigCalcContext *context);
+void BigCalcSetMaxBits(BigCalcContext *context, double maxBits);
+void BigCalcSetJobs(BigCalcContext *context, int jobs);
+
+int BigCalcFromInt(BigCalcContext *context, int64_t value, BigCalcValue **result);
+int BigCalcFromString(BigCalcContext *context, const char *decimal, BigCalcValue **result);
+void BigCalcFreeValue(BigCalcValue *value);
+
+int BigCalcAdd(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+int BigCalcSub(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+int BigCalcMultiply(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+int BigCalcDivide(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+int BigCalcModulo(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+int BigCalcExponent(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+int BigCalcPowerModulo(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, const BigCalcValue *m, BigCalcValue **result);
+int BigCalcShiftLeft(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+int BigCalcShiftRight(BigCalcContext *context, const BigCalcValue *a, const BigCalcValue *b, BigCalcValue **result);
+
+int BigCalcEvaluate(BigCalcContext *context, const char *expression, BigCalcValue **result);
+int BigCalcFormat(BigCalcContext *context, const BigCalcValue *value, char **result);
+void BigCalcFreeString(char *string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "bigcalc.h"
+
+// Checks of libbigcalc.a against known values, run with make check
+// Expected values are computed with Python integers, using truncated division and modulo with the sign of the left
+// operand. Expressions cover Montgomery power modulo, power of two and single digit fast paths, the public functions
+// and the parallel evaluator, used by several threads at once
+
+#define THREAD_COUNT 4
+
+typedef struct Check {
+    const char *expression;
+    const char *expected;
+} Check;
+
+typedef struct ErrorCheck {
+    const char *expression;
+    int status;
+} ErrorCheck;
+
+static const Check CHECKS[] = {
+    // Montgomery power modulo
+    {"123456789^987654321%1000000007", "652541198"},
+    // Montgomery power modulo, multi digit modulus
+    {"(3^500+1)^(2^200+7)%(10^40+9)", "3333506979532958472090538238445942734889"},
+    // power modulo, even modulus
+    {"7^12345%(2^130)", "806873296097611991847017643756752956103"},
+    // power modulo, even multi digit modulus
+    {"(10^40+3)^777%(10^60)", "116576491750857491274516565013876847355024111087558130753763"},
+    // power modulo, negative base
+    {"~7^13%11", "-2"},
+    // multiplication by power of two
+    {"(3^100)*(2^100)", "653318623500070906096690267158057820537143710472954871543071966369497141477376"},
+    // division by power of two
+    {"(3^100)/(2^64)", "27938671381391989327075080053"},
+    // negative division by power of two
+    {"(~3^101)/(2^64)", "-83816014144175967981225240161"},
+    // modulo by power of two
+    {"(3^100)%(2^64)", "15462121228172006353"},
+    // negative modulo by power of two
+    {"(~3^101)%(2^70)", "-618235429969512119155"},
+    // single digit multiplication
+    {"(7^100)*4294967291", "13891970812346182256616123276201551703640021411035933125618841301544920328304652753424380427291"},
+    // single digit division
+    {"(7^100)/4294967291", "753085248495960662566230418610239611917268777846118735653462123512058071139"},
+    // single digit modulo
+    {"(7^100)%4294967291", "2371945552"},
+    // negative single digit division
+    {"(~7^101)/3", "-7547111855791101979804178127900505892000140797444125935512422439913946739152832140002"},
+    // long division
+    {"(11^200+5)/(13^50+7)", "381390100633684940455369465323981381820179737319814580411545949524364164151485829873470265669040869673351006784408948676382722099855884304890168200032951"},
+    // long modulo
+    {"(11^200+5)%(13^50+7)", "7559631664446326713790858868647195812286586731099422550"},
+    // left shift
+    {"12345<<100", "15649146659817491961476801070366720"},
+    // right shift
+    {"(1<<100)>>37", "9223372036854775808"},
+    // negative right shift
+    {"~5>>1", "-2"},
+    // 64 bits overflow
+    {"18446744073709551615+1", "18446744073709551616"},
+    // 64 bits negative overflow
+    {"~9223372036854775808-1", "-9223372036854775809"},
+    // substraction to zero
+    {"(2^200)-(4^100)", "0"},
+    // independent subexpressions
+    {"((3^400+1)*(5^300-7))%(10^30+3)+(11^90-13^80)/(17^20+1)", "1307231705832215045802556985214525018041857106787970481476921873504091"},
+};
+
+static const ErrorCheck ERROR_CHECKS[] = {
+    {"1/0", BIGCALC_ERROR_DIVISION_BY_ZERO},
+    {"5%(3-3)", BIGCALC_ERROR_DIVISION_BY_ZERO},
+    {"3^1%0", BIGCALC_ERROR_DIVISION_BY_ZERO},
+    {"2^~1", BIGCALC_ERROR_NEGATIVE_EXPONENT},
+    {"2^(2^40)", BIGCALC_ERROR_EXPONENT_RANGE},
+    {"1<<~1", BIGCALC_ERROR_NEGATIVE_SHIFT},
+    {"1<<(2^40)", BIGCALC_ERROR_SHIFT_RANGE},
+    {"1+", BIGCALC_ERROR_PARSING},
+    {"(1", BIGCALC_ERROR_PARSING},
+    {"12a", BIGCALC_ERROR_PARSING}
+};
+
+#define CHECK_COUNT (int) (sizeof(CHECKS) / sizeof(CHECKS[0]))
+#define ERROR_CHECK_COUNT (int) (sizeof(ERROR_CHECKS) / sizeof(ERROR_CHECKS[0]))
+
+static int CheckExpressions(BigCalcContext *context, int jobs, int verbose);
+static int CheckErrors(BigCalcContext *context);
+static int CheckOperations(BigCalcContext *context);
+static int CheckValue(BigCalcContext *context, const char *name, int status, BigCalcValue *value, const char *expected);
+static void *RunCheckThread(void *argument);
+
+
+int main() {
+    BigCalcContext *context = BigCalcCreateContext();
+    int failures = 0;
+
+    failures += CheckExpressions(context, 1, 1);
+    failures += CheckExpressions(context, 4, 1);
+    failures += CheckErrors(context);
+    failures += CheckOperations(context);
+
+    // same expressions evaluated at once by several threads, each one with its own context and jobs
+    pthread_t threads[THREAD_COUNT];
+    int threadResults[THREAD_COUNT];    // jobs of each thread, replaced by its number of failures
+    int created = 0;
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        threadResults[i] = i % 2 + 1;
+        if (pthread_create(&threads[i], NULL, RunCheckThread, &threadResults[i]) != 0) {
+            printf("FAIL thread %d could not be created\n", i);
+            failures++;
+            break;
+        }
+        created++;
+    }
+    for (int i = 0; i < created; i++) {
+        pthread_join(threads[i], NULL);
+        failures += threadResults[i];
+    }
+
+    // estimated sizes over the limit are refused before anything is computed
+    BigCalcValue *value = NULL;
+    BigCalcSetMaxBits(context, 1000);
+    if (BigCalcEvaluate(context, "(10^1000)/(10^500-10^500+1)", &value) != BIGCALC_ERROR_TOO_LARGE) {
+        printf("FAIL max bits : expression accepted\n");
+        BigCalcFreeValue(value);
+        failures++;
+    }
+
+    BigCalcFreeContext(context);
+
+    if (failures != 0) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("All checks passed (%d expressions, %d errors, %d threads)\n", CHECK_COUNT, ERROR_CHECK_COUNT, THREAD_COUNT);
+    return 0;
+}
+
+// Evaluate all expressions with (jobs) threads and compare them with expected values
+// Returns number of failures, printed when verbose is set
+static int CheckExpressions(BigCalcContext *context, int jobs, int verbose) {
+    int failures = 0;
+
+    BigCalcSetJobs(context, jobs);
+    for (int i = 0; i < CHECK_COUNT; i++) {
+        BigCalcValue *value = NULL;
+        int status = BigCalcEvaluate(context, CHECKS[i].expression, &value);
+
+        char *decimal = NULL;
+        if (status == BIGCALC_OK) {
+            status = BigCalcFormat(context, value, &decimal);
+            BigCalcFreeValue(value);
+        }
+
+        if (status != BIGCALC_OK || strcmp(decimal, CHECKS[i].expected) != 0) {
+            if (verbose) {
+                printf("FAIL %s (%d jobs) : %s\n", CHECKS[i].expression, jobs, status == BIGCALC_OK ? decimal : BigCalcGetError(context));
+            }
+            failures++;
+        }
+        BigCalcFreeString(decimal);
+    }
+
+    return failures;
+}
+
+// Check status of expressions that fail
+static int CheckErrors(BigCalcContext *context) {
+    int failures = 0;
+
+    BigCalcSetJobs(context, 1);
+    for (int i = 0; i < ERROR_CHECK_COUNT; i++) {
+        BigCalcValue *value = NULL;
+        int status = BigCalcEvaluate(context, ERROR_CHECKS[i].expression, &value);
+        if (status != ERROR_CHECKS[i].status) {
+            printf("FAIL %s : status %d instead of %d\n", ERROR_CHECKS[i].expression, status, ERROR_CHECKS[i].status);
+            if (status == BIGCALC_OK) {
+                BigCalcFreeValue(value);
+            }
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+// Check each operation function of the library on values created from strings and integers
+static int CheckOperations(BigCalcContext *context) {
+    BigCalcValue *a, *b, *c, *e, *m, *result;
+    int failures = 0;
+
+    BigCalcFromString(context, "-123456789012345678901234567890", &a);
+    BigCalcFromInt(context, INT64_MIN, &b);
+    BigCalcFromInt(context, 97, &c);
+    BigCalcFromInt(context, 5, &e);
+    BigCalcFromString(context, "1000000007", &m);
+
+    int status = BigCalcAdd(context, a, b, &result);
+    failures += CheckValue(context, "add", status, result, "-123456789021569050938089343698");
+    status = BigCalcSub(context, a, b, &result);
+    failures += CheckValue(context, "sub", status, result, "-123456789003122306864379792082");
+    status = BigCalcMultiply(context, a, b, &result);
+    failures += CheckValue(context, "multiply", status, result, "1138687895536349070124195419011280854005705605120");
+    status = BigCalcDivide(context, a, c, &result);
+    failures += CheckValue(context, "divide", status, result, "-1272750402189130710322005854");
+    status = BigCalcModulo(context, a, c, &result);
+    failures += CheckValue(context, "modulo", status, result, "-52");
+    status = BigCalcExponent(context, a, e, &result);
+    failures += CheckValue(context, "exponent", status, result,
+        "-28679718617337040378138162708415496392486976564513250475184790028886798337811616713594453748240629383657483209495862454267363852838672048294900000");
+    status = BigCalcPowerModulo(context, e, c, m, &result);
+    failures += CheckValue(context, "power modulo", status, result, "345175854");
+    status = BigCalcShiftLeft(context, a, c, &result);
+    failures += CheckValue(context, "shift left", status, result, "-19562509086718734541693719931865871692101824685577160622080");
+    status = BigCalcShiftRight(context, a, e, &result);
+    failures += CheckValue(context, "shift right", status, result, "-3858024656635802465663580246");
+
+    if (BigCalcFromString(context, "12x", &result) != BIGCALC_ERROR_PARSING) {
+        printf("FAIL invalid number accepted\n");
+        BigCalcFreeValue(result);
+        failures++;
+    }
+
+    BigCalcFreeValue(a);
+    BigCalcFreeValue(b);
+    BigCalcFreeValue(c);
+    BigCalcFreeValue(e);
+    BigCalcFreeValue(m);
+
+    return failures;
+}
+
+// Compare value returned by an operation with expected decimal notation, and free it
+// Returns 1 on failure, 0 otherwise
+static int CheckValue(BigCalcContext *context, const char *name, int status, BigCalcValue *value, const char *expected) {
+    if (status != BIGCALC_OK) {
+        printf("FAIL %s : %s\n", name, BigCalcGetError(context));
+        return 1;
+    }
+
+    char *decimal;
+    status = BigCalcFormat(context, value, &decimal);
+    BigCalcFreeValue(value);
+    if (status != BIGCALC_OK) {
+        printf("FAIL %s : %s\n", name, BigCalcGetError(context));
+        return 1;
+    }
+
+    int failure = strcmp(decimal, expected) != 0;
+    if (failure) {
+        printf("FAIL %s : %s\n", name, decimal);
+    }
+    BigCalcFreeString(decimal);
+
+    return failure;
+}
+
+// Evaluate all expressions several times with its own context
+// argument : number of jobs on input, number of failures on output
+static void *RunCheckThread(void *argument) {
+    int *jobs = argument;
+    BigCalcContext *context = BigCalcCreateContext();
+
+    int failures = 0;
+    for (int i = 0; i < 5; i++) {
+        failures += CheckExpressions(context, *jobs, 0);
+    }
+
+    BigCalcFreeContext(context);
+    *jobs = failures;
+
+    return NULL;
+}
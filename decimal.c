@@ -0,0 +1,297 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "header.h"
+
+// Decimal evaluation of expressions made of additions, substractions and multiplications by small numbers.
+// Values are stored with base 10^18 limbs : reading and printing them are linear copies of decimal characters,
+// instead of divide and conquer conversions from and to binary.
+
+#define DECIMAL_BASE 1000000000000000000ull     // 10^18, greatest power of ten below 2^64 / 10
+#define DECIMAL_BASE_LENGTH 18
+#define HALF_DECIMAL_BASE 1000000000ull         // 10^9, limbs are split in two halves for multiplications
+#define SMALL_LITERAL_LENGTH 9                  // literals lower than 10^9 can be used as factors
+
+static DecimalInt ReadDecimalInt(Token token);
+static DecimalInt AllocateDecimalInt(int length);
+static void DecimalAdd(DecimalInt *base, DecimalInt term);
+static void DecimalAddUnsigned(DecimalInt *base, DecimalInt term);
+static void DecimalSubUnsigned(DecimalInt *base, DecimalInt term);
+static int CompareDecimalAbsoluteValue(DecimalInt a, DecimalInt b);
+static void DecimalMultiplySmall(DecimalInt *base, uint64_t factor, int negative);
+static int IsSmallDecimal(DecimalInt value);
+static void RemoveDecimalHeadZeros(DecimalInt *value);
+
+
+// Return 1 if rpn only contains additions, substractions, and multiplications with a literal lower than 10^9
+// Such expressions can be evaluated by EvaluateDecimalRpn
+int IsDecimalRpn(Rpn rpn) {
+    // for each value of RPN stack : 1 if it is a small literal
+    char *smallStack = malloc(rpn.length + 1);
+    int depth = 0;
+    int result = 1;
+
+    for (int i = 0; i < rpn.length && result; i++) {
+        Token token = rpn.tokens[i];
+
+        if (token.operator == 0) {
+            // skip head zeros
+            int start = 0;
+            while (start < token.length - 1 && token.digits[start] == '0') {
+                start++;
+            }
+            smallStack[depth] = token.length - start <= SMALL_LITERAL_LENGTH;
+            depth++;
+        } else if (token.operator == '+' || token.operator == '-') {
+            depth--;
+            smallStack[depth - 1] = 0;
+        } else if (token.operator == '*') {
+            depth--;
+            result = smallStack[depth] || smallStack[depth - 1];
+            smallStack[depth - 1] = 0;
+        } else {
+            result = 0;
+        }
+    }
+
+    free(smallStack);
+
+    return result;
+}
+
+// Compute value of RPN expression, that should be accepted by IsDecimalRpn
+DecimalInt EvaluateDecimalRpn(Rpn rpn) {
+    uint64_t profileStart = BcProfileStart();
+
+    // RPN stack can't be deeper than expression length
+    DecimalInt *stack = malloc(sizeof(DecimalInt) * (rpn.length + 1));
+    int depth = 0;
+
+    for (int i = 0; i < rpn.length; i++) {
+        Token token = rpn.tokens[i];
+
+        if (token.operator == 0) {
+            stack[depth] = ReadDecimalInt(token);
+            depth++;
+            continue;
+        }
+
+        depth--;
+        DecimalInt *base = &stack[depth - 1];
+        DecimalInt operand = stack[depth];
+
+        switch (token.operator) {
+            case '+':
+            DecimalAdd(base, operand);
+            break;
+
+            case '-':
+            operand.negative = !operand.negative;
+            DecimalAdd(base, operand);
+            break;
+
+            case '*':
+            // one of the operands is a small literal
+            if (!IsSmallDecimal(operand)) {
+                DecimalInt swap = *base;
+                *base = operand;
+                operand = swap;
+            }
+            DecimalMultiplySmall(base, operand.limbs[0], operand.negative);
+            break;
+        }
+
+        FreeDecimalInt(operand);
+    }
+
+    DecimalInt result = stack[0];
+    free(stack);
+
+    BcProfileStop(PROFILE_EVALUATION, profileStart, result.length);
+
+    return result;
+}
+
+// Print decimal notation of value
+// DecimalDetails = true : also prints decimal length
+void PrintDecimalInt(DecimalInt value, int decimalDetails) {
+    uint64_t profileStart = BcProfileStart();
+
+    if (decimalDetails) {
+        printf("--Decimal--\n");
+    }
+
+    if (value.negative) {
+        printf("-");
+    }
+
+    // most significant limb without padding, then exactly DECIMAL_BASE_LENGTH characters per limb
+    printf("%llu", (unsigned long long) value.limbs[value.length - 1]);
+    for (int i = value.length - 2; i >= 0; i--) {
+        printf("%018llu", (unsigned long long) value.limbs[i]);
+    }
+    printf("\n");
+
+    if (decimalDetails) {
+        // zero is printed as a single character
+        int decimalLength = (value.length - 1) * DECIMAL_BASE_LENGTH + 1;
+        for (uint64_t head = value.limbs[value.length - 1]; head >= 10; head /= 10) {
+            decimalLength++;
+        }
+        printf("Length\n%d\n", decimalLength);
+    }
+
+    BcProfileStop(PROFILE_DECIMAL_STRING, profileStart, value.length);
+}
+
+// Free limbs of value
+void FreeDecimalInt(DecimalInt value) {
+    BcFreeDigits((uint32_t *) value.limbs);
+}
+
+// Convert number token to DecimalInt, by groups of DECIMAL_BASE_LENGTH characters from the end
+static DecimalInt ReadDecimalInt(Token token) {
+    uint64_t profileStart = BcProfileStart();
+
+    DecimalInt result = AllocateDecimalInt((token.length + DECIMAL_BASE_LENGTH - 1) / DECIMAL_BASE_LENGTH);
+    result.negative = token.negative;
+
+    int end = token.length;
+    for (int i = 0; i < result.length; i++) {
+        int start = end > DECIMAL_BASE_LENGTH ? end - DECIMAL_BASE_LENGTH : 0;
+        uint64_t limb = 0;
+        for (int j = start; j < end; j++) {
+            limb = limb * 10 + (uint64_t) (token.digits[j] - '0');
+        }
+        result.limbs[i] = limb;
+        end = start;
+    }
+
+    RemoveDecimalHeadZeros(&result);
+
+    BcProfileStop(PROFILE_READ_NUMBER, profileStart, result.length);
+
+    return result;
+}
+
+// Return DecimalInt of given length with uninitialized limbs
+static DecimalInt AllocateDecimalInt(int length) {
+    DecimalInt result;
+    // limbs are allocated as pairs of digits, so that they follow storage options (-m)
+    result.limbs = (uint64_t *) BcAllocateDigits(2 * length);
+    result.length = length;
+    result.negative = 0;
+
+    return result;
+}
+
+// Calculate (base)+(term)
+// Result is stored in base
+static void DecimalAdd(DecimalInt *base, DecimalInt term) {
+    if (base->negative == term.negative) {
+        DecimalAddUnsigned(base, term);
+        return;
+    }
+
+    if (CompareDecimalAbsoluteValue(*base, term) >= 0) {
+        DecimalSubUnsigned(base, term);
+    } else {
+        // |term| - |base|, with the sign of term
+        DecimalInt result = AllocateDecimalInt(term.length);
+        for (int i = 0; i < term.length; i++) {
+            result.limbs[i] = term.limbs[i];
+        }
+        result.negative = term.negative;
+        DecimalSubUnsigned(&result, *base);
+        FreeDecimalInt(*base);
+        *base = result;
+    }
+}
+
+// Calculate (base)+(term), ignoring signs
+// Result is stored in base
+static void DecimalAddUnsigned(DecimalInt *base, DecimalInt term) {
+    int resultSize = (base->length > term.length ? base->length : term.length) + 1;
+    DecimalInt result = AllocateDecimalInt(resultSize);
+    result.negative = base->negative;
+
+    uint64_t carry = 0;
+    for (int i = 0; i < resultSize; i++) {
+        uint64_t limb = (i < base->length ? base->limbs[i] : 0) + (i < term.length ? term.limbs[i] : 0) + carry;
+        carry = limb >= DECIMAL_BASE;
+        result.limbs[i] = carry ? limb - DECIMAL_BASE : limb;
+    }
+
+    FreeDecimalInt(*base);
+    *base = result;
+    RemoveDecimalHeadZeros(base);
+}
+
+// Calculate (base)-(term), ignoring signs
+// Result is stored in base
+// Base should be greater in absolute value than term
+static void DecimalSubUnsigned(DecimalInt *base, DecimalInt term) {
+    uint64_t borrow = 0;
+
+    for (int i = 0; i < term.length || borrow; i++) {
+        uint64_t termLimb = (i < term.length ? term.limbs[i] : 0) + borrow;
+        borrow = base->limbs[i] < termLimb;
+        base->limbs[i] = borrow ? base->limbs[i] + DECIMAL_BASE - termLimb : base->limbs[i] - termLimb;
+    }
+
+    RemoveDecimalHeadZeros(base);
+}
+
+// Returns  1 if |a| > |b|
+// Returns -1 if |a| < |b|
+// Returns  0 if |a| = |b|
+static int CompareDecimalAbsoluteValue(DecimalInt a, DecimalInt b) {
+    if (a.length != b.length) {
+        return a.length > b.length ? 1 : -1;
+    }
+
+    for (int i = a.length - 1; i >= 0; i--) {
+        if (a.limbs[i] != b.limbs[i]) {
+            return a.limbs[i] > b.limbs[i] ? 1 : -1;
+        }
+    }
+
+    return 0;
+}
+
+// Calculate (base)*(factor), factor being lower than 10^9
+// Result is stored in base
+static void DecimalMultiplySmall(DecimalInt *base, uint64_t factor, int negative) {
+// each limb is split as high * 10^9 + low, so that partial products fit in 64 bits
+    DecimalInt result = AllocateDecimalInt(base->length + 1);
+    result.negative = base->negative != negative;
+
+    uint64_t carry = 0;     // lower than factor
+    for (int i = 0; i < base->length; i++) {
+        uint64_t low = base->limbs[i] % HALF_DECIMAL_BASE * factor + carry;
+        uint64_t high = base->limbs[i] / HALF_DECIMAL_BASE * factor + low / HALF_DECIMAL_BASE;
+        result.limbs[i] = high % HALF_DECIMAL_BASE * HALF_DECIMAL_BASE + low % HALF_DECIMAL_BASE;
+        carry = high / HALF_DECIMAL_BASE;
+    }
+    result.limbs[base->length] = carry;
+
+    FreeDecimalInt(*base);
+    *base = result;
+    RemoveDecimalHeadZeros(base);
+}
+
+// Return 1 if value can be used as a factor by DecimalMultiplySmall
+static int IsSmallDecimal(DecimalInt value) {
+    return value.length == 1 && value.limbs[0] < HALF_DECIMAL_BASE;
+}
+
+// Reduce value length to ignore useless head zeros
+static void RemoveDecimalHeadZeros(DecimalInt *value) {
+    while (value->length > 1 && value->limbs[value->length - 1] == 0) {
+        value->length--;
+    }
+
+    if (value->length == 1 && value->limbs[0] == 0) {
+        value->negative = 0;
+    }
+}
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "header.h"
+
+// Size of a value estimated without computing it
+typedef struct SizeEstimate {
+    double bits;        // upper bound of log2(|value|), 0 for values 0 and 1
+    double lowBits;     // lower bound of log2(|value|), -INFINITY unless value is known to be nonzero
+    int zero;           // 1 if value is known to be zero
+} SizeEstimate;
+
+static const double MAX_OPERAND_BITS = 32;     // exponents and shifts are single digits : greater ones are rejected
+
+static SizeEstimate EstimateNumber(Token token);
+static SizeEstimate EstimateOperation(char operator, SizeEstimate *operands, Estimate *estimate, double *temporaryBytes);
+static double GetDigitCount(SizeEstimate value);
+static double GetByteCount(SizeEstimate value);
+
+
+// Walk RPN expression and estimate size of its values, memory usage and amount of work, without computing anything
+// Sizes are upper bounds, as signs and exact values are unknown : a-a is estimated as big as a+a
+// Divisions and right shifts subtract lower bounds, which are only known for numbers and their products
+Estimate BcEstimateRpn(Rpn rpn) {
+    Estimate result;
+    result.resultBits = 0;
+    result.maxBits = 0;
+    result.peakBytes = 0;
+    result.operations = 0;
+    result.outOfRange = 0;
+
+    // RPN stack can't be deeper than expression length
+    SizeEstimate *stack = malloc(sizeof(SizeEstimate) * (rpn.length + 1));
+    int depth = 0;
+    double liveBytes = 0;   // bytes used by values in stack
+
+    for (int i = 0; i < rpn.length; i++) {
+        Token token = rpn.tokens[i];
+        SizeEstimate value;
+        double temporaryBytes = 0;
+
+        if (token.operator == 0) {
+            value = EstimateNumber(token);
+            double digits = GetDigitCount(value);
+            result.operations += digits * digits / 2 + token.length;
+        } else {
+            int operandCount = token.operator == POWER_MODULO_OPERATOR ? 3 : 2;
+            depth -= operandCount;
+            value = EstimateOperation(token.operator, stack + depth, &result, &temporaryBytes);
+            for (int j = 0; j < operandCount; j++) {
+                liveBytes -= GetByteCount(stack[depth + j]);
+            }
+        }
+
+        // operands are still allocated while result and temporary values are computed
+        double bytes = liveBytes + GetByteCount(value) + temporaryBytes;
+        if (bytes > result.peakBytes) {
+            result.peakBytes = bytes;
+        }
+
+        stack[depth] = value;
+        depth++;
+        liveBytes += GetByteCount(value);
+
+        if (value.bits > result.maxBits) {
+            result.maxBits = value.bits;
+        }
+    }
+
+    SizeEstimate value = stack[0];
+    free(stack);
+
+    // decimal conversion : the value is divided by powers of ten of half its size, then quarter of its size...
+    // each level costs about as much as a multiplication of the value by itself
+    double digits = GetDigitCount(value);
+    result.operations += 2 * digits * digits;
+
+    // decimal string uses 16 bytes (plus allocation overhead) for 18 decimal characters
+    double decimalBytes = liveBytes * 3 + (value.bits / LOG2_10 / 18 + 1) * 32;
+    if (decimalBytes > result.peakBytes) {
+        result.peakBytes = decimalBytes;
+    }
+
+    result.resultBits = value.bits;
+
+    return result;
+}
+
+// Estimate size of number token from its decimal characters
+static SizeEstimate EstimateNumber(Token token) {
+    SizeEstimate result;
+
+    // skip head zeros
+    int start = 0;
+    while (start < token.length && token.digits[start] == '0') {
+        start++;
+    }
+
+    if (start == token.length) {
+        result.bits = 0;
+        result.lowBits = -INFINITY;
+        result.zero = 1;
+        return result;
+    }
+
+    // log2(number) = log2(leading digits) + log2(10) * (number of remaining digits)
+    int leadingLength = token.length - start > 15 ? 15 : token.length - start;
+    double leading = 0;
+    for (int i = 0; i < leadingLength; i++) {
+        leading = leading * 10 + (token.digits[start + i] - '0');
+    }
+
+    // remaining digits may add up to one unit to leading digits
+    double remainingBits = LOG2_10 * (token.length - start - leadingLength);
+    double high = leadingLength < token.length - start ? leading + 1 : leading;
+
+    // small margin so that rounding errors do not make the estimation lower than the exact value
+    result.bits = log2(high) + remainingBits + 1e-9;
+    result.lowBits = log2(leading) + remainingBits - 1e-9;
+    result.zero = 0;
+
+    return result;
+}
+
+// Return estimated size of operation result, operands being in (operands) array
+// Amount of work is added to estimate, bytes used by temporary values during operation are set in (temporaryBytes)
+static SizeEstimate EstimateOperation(char operator, SizeEstimate *operands, Estimate *estimate, double *temporaryBytes) {
+    SizeEstimate a = operands[0], b = operands[1];
+    double aDigits = GetDigitCount(a), bDigits = GetDigitCount(b);
+    SizeEstimate result;
+    result.lowBits = -INFINITY;
+    result.zero = 0;
+
+    switch (operator) {
+        case '+':
+        case '-':
+        if (a.zero || b.zero) {
+            result = a.zero ? b : a;
+        } else {
+            result.bits = fmax(a.bits, b.bits) + 1;
+        }
+        estimate->operations += fmax(aDigits, bDigits);
+        break;
+
+        case '*':
+        result.bits = a.bits + b.bits;
+        result.lowBits = a.lowBits + b.lowBits;
+        result.zero = a.zero || b.zero;
+        estimate->operations += aDigits * bDigits;
+        break;
+
+        case '/':
+        case '%':
+        // quotient is at most a divided by the lowest divisor (1, unless divisor size is known), rest is lower than both operands
+        result.bits = operator == '/' ? fmax(a.bits - fmax(b.lowBits, 0), 0) : fmin(a.bits, b.bits);
+        result.zero = a.zero;
+        estimate->operations += 2 * fmax(aDigits - bDigits + 1, 1) * bDigits;
+        *temporaryBytes = 4 * (aDigits + bDigits);
+        break;
+
+        case '^':
+        // exponent value is at most 2^(b.bits), and lower than 2^32 when computation succeeds
+        if (b.bits >= MAX_OPERAND_BITS) {
+            estimate->outOfRange = 1;
+        }
+        result.bits = a.zero || b.zero ? 0 : a.bits * exp2(fmin(b.bits, MAX_OPERAND_BITS));
+        // a^0 is 1 : result is only known to be nonzero when a is
+        result.lowBits = isinf(b.lowBits) ? (isinf(a.lowBits) ? -INFINITY : 0) : a.lowBits * exp2(fmin(b.lowBits, MAX_OPERAND_BITS));
+        result.zero = a.zero && !b.zero;
+        // binary exponentiation : last squaring dominates, previous ones cost a quarter of next one
+        estimate->operations += 3 * GetDigitCount(result) * GetDigitCount(result);
+        *temporaryBytes = GetByteCount(result);
+        break;
+
+        case POWER_MODULO_OPERATOR:
+        // two Montgomery products, each one costing twice a multiplication, for each exponent bit
+        result.bits = operands[2].bits;
+        estimate->operations += (b.bits + 1) * 4 * GetDigitCount(result) * GetDigitCount(result);
+        *temporaryBytes = 4 * GetByteCount(result);
+        break;
+
+        case '<':
+        if (b.bits >= MAX_OPERAND_BITS) {
+            estimate->outOfRange = 1;
+        }
+        result.bits = a.zero || b.zero ? a.bits : a.bits + exp2(fmin(b.bits, MAX_OPERAND_BITS));
+        result.lowBits = a.lowBits + exp2(b.lowBits);
+        result.zero = a.zero;
+        estimate->operations += GetDigitCount(result);
+        break;
+
+        case '>':
+        if (b.bits >= MAX_OPERAND_BITS) {
+            estimate->outOfRange = 1;
+        }
+        // shift is at least 2^(b.lowBits), 0 when it is unknown
+        result.bits = fmax(a.bits - exp2(fmin(b.lowBits, MAX_OPERAND_BITS)), 0);
+        result.zero = a.zero;
+        estimate->operations += aDigits;
+        break;
+    }
+
+    return result;
+}
+
+// Return number of 32 bits digits of value
+static double GetDigitCount(SizeEstimate value) {
+    return floor(value.bits / 32) + 1;
+}
+
+// Return number of bytes used by value digits
+static double GetByteCount(SizeEstimate value) {
+    return 4 * GetDigitCount(value);
+}
@@ -0,0 +1,173 @@
+#include "header.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+// Stack of values used to evaluate RPN expressions
+typedef struct IntExtList {
+    IntExt value;
+    struct IntExtList *next;
+} IntExtList;
+
+static void PushToRpnStack(IntExtList **stack, IntExt value);
+static IntExt PopFromRpnStack(IntExtList **stack);
+
+IntExt BcConvertNumber(Token token);
+static int ApplyOperation(IntExtList **stack, char operator);
+
+
+// Compute value of RPN expression, stored in (result)
+// Expression should be valid, as returned by BcParseRpn
+// Returns error code of the first operation that fails, in which case nothing is left allocated
+int BcEvaluateRpn(Rpn rpn, IntExt *result) {
+    uint64_t profileStart = BcProfileStart();
+
+    IntExtList *stack = NULL;
+    int error = BIGCALC_OK;
+
+    for (int i = 0; i < rpn.length && error == BIGCALC_OK; i++) {
+        if (rpn.tokens[i].operator == 0) {
+            PushToRpnStack(&stack, BcConvertNumber(rpn.tokens[i]));
+        } else {
+            error = ApplyOperation(&stack, rpn.tokens[i].operator);
+        }
+    }
+
+    if (error != BIGCALC_OK) {
+        while (stack != NULL) {
+            BcFreeIntExt(PopFromRpnStack(&stack));
+        }
+        return error;
+    }
+
+    *result = PopFromRpnStack(&stack);
+
+    BcProfileStop(PROFILE_EVALUATION, profileStart, result->length);
+
+    return BIGCALC_OK;
+}
+
+// Return description of error code
+const char *BcGetErrorMessage(int error) {
+    switch (error) {
+        case BIGCALC_OK:
+        return "no error";
+
+        case BIGCALC_ERROR_PARSING:
+        return "invalid expression";
+
+        case BIGCALC_ERROR_DIVISION_BY_ZERO:
+        return "division by zero";
+
+        case BIGCALC_ERROR_EXPONENT_RANGE:
+        return "exponent out of range (size over 32 bits)";
+
+        case BIGCALC_ERROR_NEGATIVE_EXPONENT:
+        return "negative exponent";
+
+        case BIGCALC_ERROR_SHIFT_RANGE:
+        return "shift out of range (size over 32 bits)";
+
+        case BIGCALC_ERROR_NEGATIVE_SHIFT:
+        return "negative shift";
+
+        case BIGCALC_ERROR_TOO_LARGE:
+        return "expression too large";
+
+        case BIGCALC_ERROR_OUT_OF_MEMORY:
+        return "out of memory";
+
+        default:
+        return "unknown error";
+    }
+}
+
+// Convert number token to IntExt format
+IntExt BcConvertNumber(Token token) {
+    uint64_t profileStart = BcProfileStart();
+
+    IntExt result = BcReadDecimal(token.digits, token.length);
+    result.negative = token.negative;
+    BcRemoveHeadZeros(&result);
+
+    BcProfileStop(PROFILE_READ_NUMBER, profileStart, result.length);
+
+    return result;
+}
+
+// Reduce the two values on top of RPN stack by applying given operator
+// (three values for power modulo operator)
+// Returns error code of the operation
+static int ApplyOperation(IntExtList **stack, char operator) {
+    IntExt operand = PopFromRpnStack(stack);
+    IntExt *base = &(*stack)->value;
+
+    if (operator == POWER_MODULO_OPERATOR) {
+        IntExt power = PopFromRpnStack(stack);
+        base = &(*stack)->value;
+        int error = BcPowerModulo(base, power, operand);
+        BcFreeIntExt(power);
+        BcFreeIntExt(operand);
+        return error;
+    }
+
+    int error = BcApplyOperator(operator, base, operand);
+    BcFreeIntExt(operand);
+
+    return error;
+}
+
+// Apply binary operator to base and operand, result is stored in base
+// Returns error code of the operation
+int BcApplyOperator(char operator, IntExt *base, IntExt operand) {
+    switch(operator) {
+        case '+':
+        BcAdd(base, operand);
+        return BIGCALC_OK;
+
+        case '-':
+        BcSub(base, operand);
+        return BIGCALC_OK;
+
+        case '*':
+        BcMultiply(base, operand);
+        return BIGCALC_OK;
+
+        case '/':
+        return BcDivide(base, operand);
+
+        case '%':
+        return BcModulo(base, operand);
+
+        case '^':
+        return BcExponent(base, operand);
+
+        case '<':
+        return BcShiftLeft(base, operand);
+
+        case '>':
+        return BcShiftRight(base, operand);
+
+        default:
+        return BIGCALC_ERROR_PARSING;
+    }
+}
+
+// Push value on top of RPN stack
+static void PushToRpnStack(IntExtList **stack, IntExt value) {
+    IntExtList *new = malloc(sizeof(IntExtList));
+
+    new->next = *stack;
+    new->value = value;
+    *stack = new;
+}
+
+// Return value on top of RPN stack and remove it from the stack
+static IntExt PopFromRpnStack(IntExtList **stack) {
+    IntExt result = (*stack)->value;
+    IntExtList *newStack = (*stack)->next;
+    free(*stack);
+    *stack = newStack;
+
+    return result;
+}
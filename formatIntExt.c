@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "header.h"
+
+// Conversion of IntExt to decimal notation, with a divide and conquer algorithm using the power table
+
+static const uint32_t HALF_STRING_BASE = 1000000000;   // 10^9 : two divisions give a DecimalString element (10^18), fits in a single digit
+
+static DecimalString *CreateDecimalString(uint64_t value);
+static void AppendDecimalString(IntExt value, int rank, int padded, DecimalString ***tail);
+
+
+// Return decimal notation of intExt in a string allocated with malloc, NULL if it can't be allocated
+char *BcFormatDecimal(IntExt intExt) {
+    DecimalString *decimalString = BcComputeDecimalString(intExt);
+
+    int count = 0;
+    for (DecimalString *element = decimalString; element != NULL; element = element->next) {
+        count++;
+    }
+
+    // string is written from its end, least significant element first
+    int size = count * STRING_BASE_LENGTH + 2;
+    char *result = malloc(size);
+    if (result == NULL) {
+        BcFreeDecimalString(decimalString);
+        return NULL;
+    }
+
+    char *start = result + size - 1;
+    *start = '\0';
+
+    for (DecimalString *element = decimalString; element != NULL; element = element->next) {
+        start = BcWriteDecimalElement(start, element->value, element->next != NULL);
+    }
+    if (intExt.negative) {
+        start--;
+        *start = '-';
+    }
+
+    memmove(result, start, result + size - start);
+    BcFreeDecimalString(decimalString);
+
+    return result;
+}
+
+// Write decimal characters of value before (end) and return pointer to first character written
+// padded = 1 : write exactly STRING_BASE_LENGTH characters
+char *BcWriteDecimalElement(char *end, uint64_t value, int padded) {
+    int written = 0;
+
+    do {
+        end--;
+        *end = (char) ('0' + value % 10);
+        value /= 10;
+        written++;
+    } while (padded ? written < STRING_BASE_LENGTH : value > 0);
+
+    return end;
+}
+
+// compute and return DecimalString from intExt absolute value
+// intExt is recursively split by powers of ten : intExt = high * 10^(18 * 2^k) + low
+// high and low parts are then converted separately, low part being padded with zeros
+DecimalString *BcComputeDecimalString(IntExt intExt) {
+    uint64_t profileStart = BcProfileStart();
+
+    IntExt value = BcDuplicateIntExt(intExt);
+    value.negative = 0;
+
+    DecimalString *result = NULL;
+    DecimalString **tail = &result;
+    AppendDecimalString(value, BcGetDecimalRank(value), 0, &tail);
+
+    BcProfileStop(PROFILE_DECIMAL_STRING, profileStart, intExt.length);
+
+    return result;
+}
+
+// Return greatest rank such as 10^(18 * 2^rank) <= |value|, -1 if value is lower than 10^18
+// bit length is checked first, to avoid computing a power of ten greater than value
+int BcGetDecimalRank(IntExt value) {
+    int result = -1;
+    int64_t bitLength = BcGetBitLength(value);
+
+    while (bitLength > STRING_BASE_LENGTH * 3.321928094887362 * (double) ((int64_t) 1 << (result + 1))
+            && BcCompareAbsoluteValue(value, BcGetPowerOfTen(result + 1)) >= 0) {
+        result++;
+    }
+
+    return result;
+}
+
+// Append decimal representation of value at the end of DecimalString (tail), value being lower than 10^(18 * 2^(rank + 1))
+// padded = 1 : append exactly 2^(rank + 1) elements, as value is not the most significant part of the number
+// padded = 0 : append elements until most significant non zero one
+// value is freed
+static void AppendDecimalString(IntExt value, int rank, int padded, DecimalString ***tail) {
+    if (rank < LEAF_RANK) {
+        BcAppendDecimalStringLeaf(value, padded ? 2 << rank : 0, tail);
+        return;
+    }
+
+    IntExt power = BcGetPowerOfTen(rank);
+
+    if (!padded && BcCompareAbsoluteValue(value, power) < 0) {
+        // high part would be zero
+        AppendDecimalString(value, rank - 1, 0, tail);
+        return;
+    }
+
+    IntExt low;
+    BcEuclideanDivision(&value, power, &low);
+
+    // least significant part first
+    AppendDecimalString(low, rank - 1, 1, tail);
+    AppendDecimalString(value, rank - 1, padded, tail);
+}
+
+// Append decimal representation of value at the end of DecimalString (tail)
+// count = 0 : append elements until value is zero, at least one
+// count > 0 : append exactly (count) elements
+// value is freed
+void BcAppendDecimalStringLeaf(IntExt value, int count, DecimalString ***tail) {
+    int appended = 0;
+
+    do {
+        uint64_t low = BcSingleDigitDivide(&value, HALF_STRING_BASE);
+        uint64_t high = BcSingleDigitDivide(&value, HALF_STRING_BASE);
+
+        DecimalString *element = CreateDecimalString(high * HALF_STRING_BASE + low);
+        **tail = element;
+        *tail = &element->next;
+        appended++;
+    } while (count == 0 ? !BcIsZero(value) : appended < count);
+
+    BcFreeIntExt(value);
+}
+
+// Return DecimalString with given value
+static DecimalString *CreateDecimalString(uint64_t value) {
+    DecimalString *result = BcProfileMalloc(sizeof(DecimalString));
+    result->value = value;
+    result->next = NULL;
+    return result;
+}
+
+// Recursively free all elements in string
+void BcFreeDecimalString(DecimalString *string) {
+    DecimalString *next = string->next;
+
+    BcProfileFree(string);
+    if (next != NULL) {
+        BcFreeDecimalString(next);
+    }
+}
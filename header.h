@@ -1,28 +1,186 @@
 #include <stdint.h>
+#include <stddef.h>
+#include "bigcalc.h"
+
+// Functions of libbigcalc.a used by several of its files are prefixed with Bc, the other ones are static.
+// Functions of calculate program, which are not part of the library, are declared at the end of this file.
+
+#define INLINE_LENGTH 2     // numbers of at most INLINE_LENGTH digits are stored in IntExt itself, without allocation
 
 // extended int format, composed of multiple 32 bits components
 // we use 32 bits digits so that we can simply handle airthmetic overflows by using 64 bits numbers
+// digits are read and written through GetDigits, as they can be stored in an allocated array or in inlineDigits
 typedef struct IntExt {
-    uint32_t *digits;   // array of 32 bits components (later called digits). first one is least significant
-    int length;         // number of digits
-    int negative;       // 0 if number is positive or nulle, 1 if negative
+    uint32_t *allocatedDigits;              // array of 32 bits components (later called digits), NULL for inline digits
+    int length;                             // number of digits
+    int negative;                           // 0 if number is positive or nulle, 1 if negative
+    uint32_t inlineDigits[INLINE_LENGTH];   // digits of small numbers. first one is least significant
 } IntExt;
 
+// Return digit array of intExt, first digit being least significant
+// Inline digits belong to *intExt : returned pointer is valid as long as *intExt is not moved or freed
+static inline uint32_t *GetDigits(IntExt *intExt) {
+    return intExt->allocatedDigits != NULL ? intExt->allocatedDigits : intExt->inlineDigits;
+}
+
+
+IntExt BcInitiateIntExt(uint32_t value, int negative);
+IntExt BcInitiateIntExtZero(int length);
+IntExt BcAllocateIntExt(int length);
+IntExt BcDuplicateIntExt(IntExt intExt);
+void BcResizeIntExt(IntExt *intExt, int length);
+void BcFreeIntExt(IntExt IntExt);
+uint32_t BcGetDigit(IntExt intExt, int rank);
+int BcGetBit(IntExt intExt, int64_t rank);
+int64_t BcGetBitLength(IntExt intExt);
+int BcIsZero(IntExt intExt);
+int BcCompareAbsoluteValue(IntExt a, IntExt b);
+void BcRemoveHeadZeros(IntExt *intExt);
+void BcNullify(IntExt *intExt);
+void BcReplaceDigits(IntExt *intExt, IntExt value);
+int BcIsSmall(IntExt intExt);
+uint64_t BcGetSmallValue(IntExt intExt);
+void BcSetSmallValue(IntExt *intExt, uint64_t value);
+uint32_t *BcAllocateDigits(int length);
+uint32_t *BcResizeDigits(uint32_t *digits, int previousLength, int length);
+void BcFreeDigits(uint32_t *digits);
+void BcSetStorageDirectory(char *directory);
+
+#define STRING_BASE_LENGTH 18   // decimal characters per DecimalString element
+#define LEAF_RANK 2             // numbers lower than 10^(18 * 2^LEAF_RANK) are converted without power table
+#define LOG2_10 3.321928094887362
+
+// Chained list to store decimal values while converting IntExt to decimal
+// Head is least significant
+typedef struct DecimalString {
+    uint64_t value;                 // will be between 0 and 10^18 - 1
+    struct DecimalString *next;
+} DecimalString;
+
+char *BcFormatDecimal(IntExt intExt);
+char *BcWriteDecimalElement(char *end, uint64_t value, int padded);
+DecimalString *BcComputeDecimalString(IntExt intExt);
+int BcGetDecimalRank(IntExt value);
+void BcAppendDecimalStringLeaf(IntExt value, int count, DecimalString ***tail);
+void BcFreeDecimalString(DecimalString *string);
+IntExt BcReadDecimal(char *decimal, int length);
+
+void BcSetPowerTableCache(char *directory);
+IntExt BcGetPowerOfTen(int rank);
+void BcFreePowerTable();
+
+void BcAdd(IntExt *base, IntExt term);
+void BcSub(IntExt *base, IntExt term);
+void BcMultiply(IntExt *base, IntExt factor);
+int BcDivide(IntExt *base, IntExt dividend);
+int BcModulo(IntExt *base, IntExt modulus);
+int BcEuclideanDivision(IntExt *base, IntExt dividend, IntExt *rest);
+uint32_t BcSingleDigitDivide(IntExt *base, uint32_t digit);
+int BcExponent(IntExt *base, IntExt power);
+int BcPowerModulo(IntExt *base, IntExt power, IntExt modulus);
+int BcShiftLeft(IntExt *base, IntExt shift);
+int BcShiftRight(IntExt *base, IntExt shift);
+
+// Operator used internally for (a^b)%m, reduced as a single operation on 3 operands
+// It is never read from input
+#define POWER_MODULO_OPERATOR '$'
+
+// Token of an expression in reverse polish notation : number or operator
+typedef struct Token {
+    char operator;      // operator character, 0 for numbers
+    int negative;       // numbers only : 1 if number is preceded by ~
+    char *digits;       // numbers only : decimal characters, pointing to program input
+    int length;         // numbers only : number of decimal characters
+} Token;
 
-IntExt InitiateIntExt(uint32_t value, int negative);
-IntExt InitiateIntExtZero(int length);
-IntExt DuplicateIntExt(IntExt intExt);
-void FreeIntExt(IntExt IntExt);
-uint32_t GetDigit(IntExt intExt, int rank);
-void RemoveHeadZeros(IntExt *intExt);
-void Nullify(IntExt *intExt);
+// Expression in reverse polish notation, output of shunting yard algorithm
+typedef struct Rpn {
+    Token *tokens;
+    int length;
+} Rpn;
+
+int BcParseRpn(char *arg, size_t length, Rpn *rpn, const char **errorMessage);
+void BcFreeRpn(Rpn rpn);
+int BcEvaluateRpn(Rpn rpn, IntExt *result);
+int BcEvaluateRpnParallel(Rpn rpn, int jobs, IntExt *result);
+int BcGetProcessorCount();
+IntExt BcConvertNumber(Token token);
+int BcApplyOperator(char operator, IntExt *base, IntExt operand);
+const char *BcGetErrorMessage(int error);
+
+// Cost of an expression, estimated without computing it
+typedef struct Estimate {
+    double resultBits;      // upper bound of log2(|result|)
+    double maxBits;         // upper bound of log2 of greatest value computed
+    double peakBytes;       // memory used by digits
+    double operations;      // number of operations on single digits
+    int outOfRange;         // 1 if an exponent or a shift may be 2^32 or more, which makes computation fail
+} Estimate;
+
+Estimate BcEstimateRpn(Rpn rpn);
+
+// phases measured by profiling (-p option)
+// operand sizes are counted in digits, except for parsing (in tokens)
+enum ProfilePhase {
+    PROFILE_PARSE,
+    PROFILE_EVALUATION,
+    PROFILE_READ_NUMBER,
+    PROFILE_MULTIPLY,
+    PROFILE_DIVIDE,
+    PROFILE_EXPONENT,
+    PROFILE_POWER_MODULO,
+    PROFILE_DECIMAL_STRING,
+    PROFILE_POWER_TABLE,
+    PROFILE_PHASE_COUNT
+};
+
+#define PROFILE_HISTOGRAM_SIZE 32   // operand sizes are grouped by power of two (in digits)
+
+// Counters of a single profiled phase
+typedef struct PhaseCounters {
+    uint64_t calls;
+    uint64_t nanoseconds;
+    uint64_t histogram[PROFILE_HISTOGRAM_SIZE];    // histogram[k] : calls with operand length in [2^k, 2^(k+1))
+} PhaseCounters;
+
+// Profiling counters of all phases and allocations
+typedef struct Profile {
+    PhaseCounters phases[PROFILE_PHASE_COUNT];
+    uint64_t allocationCount;
+    uint64_t allocatedBytes;
+    uint64_t currentBytes;
+    uint64_t peakBytes;
+    uint64_t currentMappedBytes;
+    uint64_t peakMappedBytes;
+} Profile;
+
+void BcEnableProfiling();
+void BcGetProfile(Profile *result);
+uint64_t BcProfileStart();
+void BcProfileStop(int phase, uint64_t start, int operandLength);
+void *BcProfileMalloc(size_t size);
+void *BcProfileRealloc(void *ptr, size_t size);
+void BcProfileFree(void *ptr);
+void BcProfileMapping(int64_t size);
+
+
+// calculate program
 
 void PrintIntExt(IntExt intExt, int binaryDetails, int decimalDetails);
+void StreamIntExt(IntExt intExt, int binaryDetails, int decimalDetails);
+char *ReadInput(char *fileName, size_t *length, int *mapped);
+void FreeInput(char *input, size_t length, int mapped);
+void PrintEstimate(Estimate estimate);
+void PrintProfilingReport();
 
-void Add(IntExt *base, IntExt term);
-void Sub(IntExt *base, IntExt term);
-void Multiply(IntExt *base, IntExt factor);
-void Divide(IntExt *base, IntExt dividend);
-void Exponent(IntExt *base, IntExt power);
+// Number stored with base 10^18 limbs, used to evaluate expressions without binary conversion
+typedef struct DecimalInt {
+    uint64_t *limbs;    // limbs between 0 and 10^18 - 1, first one is least significant
+    int length;         // number of limbs
+    int negative;       // 0 if number is positive or nulle, 1 if negative
+} DecimalInt;
 
-IntExt ParseExpression(char *argv);
+int IsDecimalRpn(Rpn rpn);
+DecimalInt EvaluateDecimalRpn(Rpn rpn);
+void PrintDecimalInt(DecimalInt value, int decimalDetails);
+void FreeDecimalInt(DecimalInt value);
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "header.h"
+
+// Expressions too long for program arguments are read from a file or from standard input.
+// Regular files are memory mapped : number tokens point to the mapping, so that digits are never copied
+// and pages are only read when numbers are converted.
+
+#define READ_BLOCK_SIZE (1 << 16)
+
+static char *MapInputFile(int file, size_t *length);
+static char *ReadInputStream(int file, size_t *length);
+
+
+// Return content of given file ("-" for standard input), its length being set in (length)
+// Content is not null terminated. It should be freed with FreeInput
+char *ReadInput(char *fileName, size_t *length, int *mapped) {
+    int file = fileName[0] == '-' && fileName[1] == '\0' ? STDIN_FILENO : open(fileName, O_RDONLY);
+    if (file < 0) {
+        printf("Error : cannot open %s\n", fileName);
+        exit(1);
+    }
+
+    // standard input is mapped too when it is redirected from a regular file
+    char *result = MapInputFile(file, length);
+    *mapped = result != NULL;
+    if (result == NULL) {
+        result = ReadInputStream(file, length);
+    }
+
+    if (file != STDIN_FILENO) {
+        close(file);
+    }
+
+    return result;
+}
+
+// Free content returned by ReadInput
+void FreeInput(char *input, size_t length, int mapped) {
+    if (mapped) {
+        munmap(input, length);
+    } else {
+        free(input);
+    }
+}
+
+// Return mapping of a regular file, NULL if file can't be mapped
+static char *MapInputFile(int file, size_t *length) {
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size == 0) {
+        return NULL;
+    }
+
+    *length = (size_t) fileStat.st_size;
+    void *result = mmap(NULL, *length, PROT_READ, MAP_PRIVATE, file, 0);
+    if (result == MAP_FAILED) {
+        return NULL;
+    }
+
+    // the parser reads the file once from start to end
+    posix_madvise(result, *length, POSIX_MADV_SEQUENTIAL);
+
+    return result;
+}
+
+// Read file until its end, for pipes and terminals
+static char *ReadInputStream(int file, size_t *length) {
+    size_t capacity = READ_BLOCK_SIZE;
+    char *result = malloc(capacity);
+    *length = 0;
+
+    while (1) {
+        if (*length == capacity) {
+            capacity *= 2;
+            result = realloc(result, capacity);
+        }
+        if (result == NULL) {
+            printf("Error : out of memory\n");
+            exit(1);
+        }
+
+        ssize_t count = read(file, result + *length, capacity - *length);
+        if (count < 0) {
+            printf("Error : cannot read input\n");
+            exit(1);
+        }
+        if (count == 0) {
+            return result;
+        }
+        *length += (size_t) count;
+    }
+}
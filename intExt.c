@@ -5,75 +5,162 @@
 #include "header.h"
 
 // Return IntExt with single digit equal to given value
-IntExt InitiateIntExt(uint32_t value, int negative) {
+IntExt BcInitiateIntExt(uint32_t value, int negative) {
     IntExt result;
-    result.digits = malloc(sizeof(uint32_t) * 1);
-    result.digits[0] = value;
+    result.allocatedDigits = NULL;
+    result.inlineDigits[0] = value;
     result.length = 1;
     result.negative = negative;
 
     return result;
 }
 
-// Return IntExt of given length with every digit equal to zero
-IntExt InitiateIntExtZero(int length) {
+// Return positive IntExt of given length with uninitialized digits
+// Digits are stored inline up to INLINE_LENGTH digits, they are allocated otherwise
+IntExt BcAllocateIntExt(int length) {
     IntExt result;
-    result.digits = malloc(sizeof(uint32_t) * length);
+    result.allocatedDigits = length > INLINE_LENGTH ? BcAllocateDigits(length) : NULL;
     result.length = length;
     result.negative = 0;
 
+    return result;
+}
+
+// Return IntExt of given length with every digit equal to zero
+IntExt BcInitiateIntExtZero(int length) {
+    IntExt result = BcAllocateIntExt(length);
+
+    uint32_t *digits = GetDigits(&result);
     for (int i = 0; i < length; i++) {
-        result.digits[i] = 0;
+        digits[i] = 0;
     }
 
     return result;
 }
 
 // Return IntExt copy of value
-IntExt DuplicateIntExt(IntExt value) {
-    IntExt result;
-    result.length = value.length;
+IntExt BcDuplicateIntExt(IntExt value) {
+    IntExt result = BcAllocateIntExt(value.length);
     result.negative = value.negative;
-    result.digits = malloc(sizeof(uint32_t) * value.length);
 
+    uint32_t *digits = GetDigits(&result);
+    uint32_t *valueDigits = GetDigits(&value);
     for (int i = 0; i < value.length; i++) {
-        result.digits[i] = value.digits[i];
+        digits[i] = valueDigits[i];
     }
 
     return result;
 }
 
+// Extend intExt to given length, not lower than its current one. Added most significant digits are set to zero
+// Allocated digits are resized in place when possible, so that operations can extend a value without copying it
+void BcResizeIntExt(IntExt *intExt, int length) {
+    int previousLength = intExt->length;
+
+    if (length > INLINE_LENGTH) {
+        if (intExt->allocatedDigits != NULL) {
+            intExt->allocatedDigits = BcResizeDigits(intExt->allocatedDigits, previousLength, length);
+        } else {
+            uint32_t *digits = BcAllocateDigits(length);
+            for (int i = 0; i < previousLength; i++) {
+                digits[i] = intExt->inlineDigits[i];
+            }
+            intExt->allocatedDigits = digits;
+        }
+    }
+
+    intExt->length = length;
+    uint32_t *digits = GetDigits(intExt);
+    for (int i = previousLength; i < length; i++) {
+        digits[i] = 0;
+    }
+}
+
 // Free digit array of intExt
-void FreeIntExt(IntExt intExt) {
-    free(intExt.digits);
+void BcFreeIntExt(IntExt intExt) {
+    if (intExt.allocatedDigits != NULL) {
+        BcFreeDigits(intExt.allocatedDigits);
+    }
 }
 
 // Return intExt's digit of given rank
-uint32_t GetDigit(IntExt intExt, int rank) {
-    uint32_t result = rank < intExt.length? intExt.digits[rank] : 0;
+uint32_t BcGetDigit(IntExt intExt, int rank) {
+    uint32_t result = rank < intExt.length? GetDigits(&intExt)[rank] : 0;
+
+    return result;
+}
+
+// Return bit of given rank in intExt absolute value
+int BcGetBit(IntExt intExt, int64_t rank) {
+    return (BcGetDigit(intExt, (int) (rank / 32)) >> (rank % 32)) & 1;
+}
+
+// Return number of significant bits in intExt absolute value
+int64_t BcGetBitLength(IntExt intExt) {
+    int64_t result = (int64_t) (intExt.length - 1) * 32;
+    uint32_t head = GetDigits(&intExt)[intExt.length - 1];
+
+    while (head != 0) {
+        result++;
+        head = head >> 1;
+    }
 
     return result;
 }
 
+// Return 1 if intExt is equal to zero, 0 otherwise
+int BcIsZero(IntExt intExt) {
+    return intExt.length == 1 && GetDigits(&intExt)[0] == 0;
+}
+
 // Reduce intExt length to ignore useless head zeros
-void RemoveHeadZeros(IntExt *intExt) {
+void BcRemoveHeadZeros(IntExt *intExt) {
+    uint32_t *digits = GetDigits(intExt);
+
     for (int i = intExt->length - 1; i > 0; i--) {
-        if (intExt->digits[i] == 0) {
+        if (digits[i] == 0) {
             intExt->length--;
         } else {
             return;
         }
     }
-    if (intExt->length == 1 && intExt->digits[0] == 0) {
+    if (intExt->length == 1 && digits[0] == 0) {
         intExt->negative = 0;
     } 
 }
 
 // Set intExt to zero
-void Nullify(IntExt *intExt) {
-    free(intExt->digits);
-    intExt->digits = malloc(sizeof(uint32_t) * 1);
-    intExt->digits[0] = 0;
-    intExt->length = 1;
-    intExt->negative = 0;
+void BcNullify(IntExt *intExt) {
+    BcFreeIntExt(*intExt);
+    *intExt = BcInitiateIntExt(0, 0);
+}
+
+// Free digits of intExt and replace them with digits of value, keeping intExt sign
+// value is moved into intExt : it should not be used or freed afterwards
+void BcReplaceDigits(IntExt *intExt, IntExt value) {
+    BcFreeIntExt(*intExt);
+    value.negative = intExt->negative;
+    *intExt = value;
+}
+
+// Return 1 if intExt absolute value fits in 64 bits, so that it can be computed with native integers
+int BcIsSmall(IntExt intExt) {
+    return intExt.length <= INLINE_LENGTH;
+}
+
+// Return absolute value of a small intExt
+uint64_t BcGetSmallValue(IntExt intExt) {
+    uint32_t *digits = GetDigits(&intExt);
+
+    return intExt.length == 1 ? digits[0] : ((uint64_t) digits[1] << 32) | digits[0];
+}
+
+// Set absolute value of intExt to a 64 bits value, stored inline. Sign is kept, unless value is zero
+void BcSetSmallValue(IntExt *intExt, uint64_t value) {
+    BcFreeIntExt(*intExt);
+    intExt->allocatedDigits = NULL;
+    intExt->inlineDigits[0] = (uint32_t) value;
+    intExt->inlineDigits[1] = (uint32_t) (value >> 32);
+    intExt->length = 2;
+    BcRemoveHeadZeros(intExt);
 }
@@ -1,16 +1,42 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
 #include <sys/timeb.h>
 #include "header.h"
 
 int main(int argc, char *argv[]) {
     char *expression = NULL;
+    char *inputFileName = NULL;
     int binaryOption = 0;
     int decimalOption = 0;
+    int streamOption = 0;
+    int estimateOption = 0;
+    double maxBits = 0;         // 0 : no limit
+    int jobs = BcGetProcessorCount();
 
     for (int i = 1; i < argc; i++) {
-        if (argv[i][0] == '-') {
+        if (argv[i][0] == '-' && argv[i][1] == '-') {
+            if (strcmp(argv[i], "--estimate") == 0) {
+                estimateOption = 1;
+            } else if (strcmp(argv[i], "--max-bits") == 0) {
+                if (i + 1 >= argc || (maxBits = strtod(argv[i + 1], NULL)) <= 0) {
+                    printf("Positive number of bits expected after --max-bits\n");
+                    exit(1);
+                }
+                i++;
+            } else {
+                printf("Unknown option\n");
+                exit(1);
+            }
+        } else if (argv[i][0] == '-') {
+            if (argv[i][1] == '\0' || argv[i][2] != '\0') {
+                printf("Unknown option\n");
+                exit(1);
+            }
+
             switch (argv[i][1]) {
                 case 'b':
                 binaryOption = 1;
@@ -20,14 +46,54 @@ int main(int argc, char *argv[]) {
                 decimalOption = 1;
                 break;
 
+                case 's':
+                streamOption = 1;
+                break;
+
+                case 'p':
+                BcEnableProfiling();
+                atexit(PrintProfilingReport);
+                break;
+
+                case 'c':
+                if (i + 1 >= argc) {
+                    printf("Cache directory expected after -c\n");
+                    exit(1);
+                }
+                i++;
+                BcSetPowerTableCache(argv[i]);
+                break;
+
+                case 'f':
+                if (i + 1 >= argc) {
+                    printf("File name expected after -f\n");
+                    exit(1);
+                }
+                i++;
+                inputFileName = argv[i];
+                break;
+
+                case 'j':
+                if (i + 1 >= argc || (jobs = atoi(argv[i + 1])) < 1) {
+                    printf("Positive number of jobs expected after -j\n");
+                    exit(1);
+                }
+                i++;
+                break;
+
+                case 'm':
+                if (i + 1 >= argc) {
+                    printf("Storage directory expected after -m\n");
+                    exit(1);
+                }
+                i++;
+                BcSetStorageDirectory(argv[i]);
+                break;
+
                 default:
                 printf("Unknown option\n");
                 exit(1);
             }
-            if (argv[i][2] != '\0') {
-                printf("Unknown option\n");
-                exit(1);
-            }
         } else {
             if (expression != NULL) {
                 printf("One single argument expected\n");
@@ -37,8 +103,84 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    IntExt result = ParseExpression(expression);
-    PrintIntExt(result, binaryOption, decimalOption);
-    FreeIntExt(result);
+    if (expression != NULL && inputFileName != NULL) {
+        printf("One single argument expected\n");
+        exit(1);
+    }
+
+    // without expression argument, expression is read from standard input unless it is a terminal
+    if (expression == NULL && inputFileName == NULL && !isatty(STDIN_FILENO)) {
+        inputFileName = "-";
+    }
+
+    size_t expressionLength;
+    int inputMapped = 0;
+    if (inputFileName != NULL) {
+        expression = ReadInput(inputFileName, &expressionLength, &inputMapped);
+    } else if (expression != NULL) {
+        expressionLength = strlen(expression);
+    } else {
+        printf("Expression expected\n");
+        exit(1);
+    }
+
+    Rpn rpn;
+    const char *parsingMessage;
+    uint64_t profileStart = BcProfileStart();
+    if (BcParseRpn(expression, expressionLength, &rpn, &parsingMessage) != BIGCALC_OK) {
+        printf("Parsing error : %s\n", parsingMessage);
+        exit(0);
+    }
+    BcProfileStop(PROFILE_PARSE, profileStart, rpn.length);
+
+    if (estimateOption || maxBits > 0) {
+        // estimation only reads the expression, nothing is allocated for its values
+        Estimate estimate = BcEstimateRpn(rpn);
+
+        if (estimateOption) {
+            PrintEstimate(estimate);
+            BcFreeRpn(rpn);
+            exit(0);
+        }
+
+        if (!(estimate.maxBits < maxBits)) {
+            printf("Error : expression too large (estimated %.0f bits, limit is %.0f bits)\n", floor(estimate.maxBits) + 1, maxBits);
+            BcFreeRpn(rpn);
+            exit(1);
+        }
+    }
+
+    if (IsDecimalRpn(rpn) && !binaryOption) {
+        // only additions, substractions and small multiplications : no conversion to binary and back
+        DecimalInt result = EvaluateDecimalRpn(rpn);
+        BcFreeRpn(rpn);
+        if (inputFileName != NULL) {
+            FreeInput(expression, expressionLength, inputMapped);
+        }
+
+        PrintDecimalInt(result, decimalOption);
+        FreeDecimalInt(result);
+        exit(0);
+    }
+
+    IntExt result;
+    int error = BcEvaluateRpnParallel(rpn, jobs, &result);
+    BcFreeRpn(rpn);
+    if (inputFileName != NULL) {
+        FreeInput(expression, expressionLength, inputMapped);
+    }
+    if (error != BIGCALC_OK) {
+        printf("Error : %s\n", BcGetErrorMessage(error));
+        exit(1);
+    }
+
+    if (streamOption) {
+        // result is freed while it is printed
+        StreamIntExt(result, binaryOption, decimalOption);
+    } else {
+        PrintIntExt(result, binaryOption, decimalOption);
+        BcFreeIntExt(result);
+    }
+    BcFreePowerTable();
 }
 
@@ -4,60 +4,106 @@
 #include <time.h>
 #include "header.h"
 
-void AddUnsigned(IntExt *base, IntExt term);
-void SubUnsigned(IntExt *base, IntExt term);
-int CompareAbsoluteValue(IntExt base, IntExt term);
-int Compare32(uint32_t a, uint32_t b);
-IntExt SingleDigitMultiply(IntExt intExt, uint32_t digit);
-uint32_t ProcessDivision(IntExt *quotient, IntExt dividend);
+#define MULTIPLY_BLOCK_LENGTH 4096  // digits of biggest operand processed together by MultiplyGeneric
+
+static void AddUnsigned(IntExt *base, IntExt term);
+static void SubUnsigned(IntExt *base, IntExt term);
+static void SubFromUnsigned(IntExt *base, IntExt term);
+static int Compare32(uint32_t a, uint32_t b);
+static IntExt SingleDigitMultiply(IntExt intExt, uint32_t digit);
+static void WriteSingleDigitProduct(IntExt intExt, uint32_t digit, IntExt *result);
+static uint32_t ProcessDivision(IntExt *quotient, IntExt dividend, IntExt *subMult);
+static uint32_t GetShiftedDigit(uint32_t *digits, int length, int rank, int shift);
+static void MultiplyGeneric(IntExt *base, IntExt factor);
+static int64_t GetPowerOfTwoRank(IntExt intExt);
+static void ShiftLeftBits(IntExt *intExt, int64_t bits);
+static void ShiftRightBits(IntExt *intExt, int64_t bits);
+static void KeepLowestBits(IntExt *intExt, int64_t bits);
 
 
 // Calculate (base)^(power)
-// Result is stored in base
-void Exponent(IntExt *base, IntExt power) {
-    // Perform binary exponentiation
-    IntExt result = InitiateIntExt(1, 0);
-    IntExt factor = DuplicateIntExt(*base);
-
+// Result is stored in base. Returns error code if power is negative or too large
+int BcExponent(IntExt *base, IntExt power) {
     if (power.length != 1) {
-        printf("Error : exponent out of range (size over 32 bits)\n");
-        exit(1);
+        return BIGCALC_ERROR_EXPONENT_RANGE;
     }
 
     if (power.negative) {
-        printf("Error : negative exponent\n");
-        exit(1);
+        return BIGCALC_ERROR_NEGATIVE_EXPONENT;
     }
 
-    uint32_t power32 = power.digits[0];
+    uint64_t profileStart = BcProfileStart();
+    int operandLength = base->length;
+
+    // Perform binary exponentiation
+    IntExt result = BcInitiateIntExt(1, 0);
+    IntExt factor = BcDuplicateIntExt(*base);
+
+    uint32_t power32 = GetDigits(&power)[0];
     uint32_t oddPower = power32%2;
 
     while (power32 != 0) {
         if (power32%2) {
-            Multiply(&result, factor);
+            BcMultiply(&result, factor);
         }
 
-        Multiply(&factor, factor);
+        BcMultiply(&factor, factor);
         power32 = power32>>1;
     }
 
-    free(base->digits);
-    base->digits = result.digits;
-    base->length = result.length;
+    BcReplaceDigits(base, result);
     if (base->negative && oddPower) {
         base->negative = 1;
     } else {
         base->negative = 0;
     }
 
-    RemoveHeadZeros(base);
+    BcRemoveHeadZeros(base);
 
-    free(factor.digits);
+    BcFreeIntExt(factor);
+
+    BcProfileStop(PROFILE_EXPONENT, profileStart, operandLength);
+
+    return BIGCALC_OK;
 }
 
 // Calculate (base)*(factor)
 // Result is stored in base
-void Multiply(IntExt *base, IntExt factor) {
+void BcMultiply(IntExt *base, IntExt factor) {
+    // choose algorithm according to operands :
+    // single digit operands have a 64 bits product, powers of two are shifts,
+    // a single digit operand needs a single pass
+    uint64_t profileStart = BcProfileStart();
+    int operandLength = base->length > factor.length ? base->length : factor.length;
+    int negative = base->negative != factor.negative;
+
+    int64_t rank;
+    if (base->length + factor.length <= INLINE_LENGTH) {
+        BcSetSmallValue(base, BcGetSmallValue(*base) * BcGetSmallValue(factor));
+    } else if ((rank = GetPowerOfTwoRank(factor)) >= 0) {
+        ShiftLeftBits(base, rank);
+    } else if ((rank = GetPowerOfTwoRank(*base)) >= 0) {
+        IntExt result = BcDuplicateIntExt(factor);
+        ShiftLeftBits(&result, rank);
+        BcReplaceDigits(base, result);
+    } else if (factor.length == 1 || base->length == 1) {
+        IntExt result = base->length == 1
+                ? SingleDigitMultiply(factor, GetDigits(base)[0])
+                : SingleDigitMultiply(*base, GetDigits(&factor)[0]);
+        BcReplaceDigits(base, result);
+    } else {
+        MultiplyGeneric(base, factor);
+    }
+
+    base->negative = negative;
+    BcRemoveHeadZeros(base);
+
+    BcProfileStop(PROFILE_MULTIPLY, profileStart, operandLength);
+}
+
+// Calculate (base)*(factor), for any operands
+// Result is stored in base
+static void MultiplyGeneric(IntExt *base, IntExt factor) {
 // decompose intExt multiplication into a sum of digit * intExt multiplications
 // works just the same as hand multiplications (don't forget the carry)
 // ex : 
@@ -69,10 +115,12 @@ void Multiply(IntExt *base, IntExt factor) {
 //  ------------------------     
 //  ...      
 // note : may reserve 1 digit more than needed, that won't be integrated in intExt length
+// rows are added directly to result. biggest is processed by blocks of MULTIPLY_BLOCK_LENGTH digits :
+// for each block, smallest and result are swept sequentially while the block stays in cache
     int resultSize = base->length + factor.length;
-    IntExt result = InitiateIntExtZero(resultSize);
+    IntExt result = BcInitiateIntExtZero(resultSize);
 
-    // differentiate biggest and smallest number, to reduce amount of additions
+    // differentiate biggest and smallest number, to reduce amount of carry propagations
     IntExt smallest, biggest;
     if (base->length > factor.length) {
         smallest = factor;
@@ -81,41 +129,64 @@ void Multiply(IntExt *base, IntExt factor) {
         smallest = *base;
         biggest = factor;
     }
+    uint32_t *smallestDigits = GetDigits(&smallest);
+    uint32_t *biggestDigits = GetDigits(&biggest);
+    uint32_t *resultDigits = GetDigits(&result);
+
+    for (int blockStart = 0; blockStart < biggest.length; blockStart += MULTIPLY_BLOCK_LENGTH) {
+        int blockEnd = blockStart + MULTIPLY_BLOCK_LENGTH;
+        if (blockEnd > biggest.length) {
+            blockEnd = biggest.length;
+        }
 
-    for (int i = 0; i < smallest.length; i++) {
-        // multiply (biggest) by digit of rank i in (smallest)
-        // complete with enough 0 at the end and add to result
-        // repeat for each digit in smallest
-        int termSize = i + biggest.length + 1;
-        IntExt term = InitiateIntExtZero(termSize);
+        for (int i = 0; i < smallest.length; i++) {
+            // add (block of biggest) * (digit of rank i in smallest) to result, shifted by i digits
+            uint64_t carry = 0, digit = (uint64_t) smallestDigits[i];
+            uint32_t *row = resultDigits + i;
+            for (int j = blockStart; j < blockEnd; j++) {
+                uint64_t multResult = digit * (uint64_t) biggestDigits[j] + (uint64_t) row[j] + carry;
+                row[j] = (uint32_t) multResult;
+                carry = multResult >> 32;
+            }
 
-        uint64_t carry = 0, factor = (uint64_t) GetDigit(smallest, i);
-        for (int j = 0; j < biggest.length; j++) {
-            uint64_t multResult = factor * (uint64_t) GetDigit(biggest, j) + carry;
-            term.digits[i + j] = (uint32_t) multResult;
-            carry = multResult >> 32;
+            // propagate carry after the block
+            for (int j = blockEnd; carry != 0; j++) {
+                uint64_t sum = (uint64_t) row[j] + carry;
+                row[j] = (uint32_t) sum;
+                carry = sum >> 32;
+            }
         }
-        term.digits[i + biggest.length] = (uint32_t) carry;
-
-        Add(&result, term);
-        free(term.digits);
     }
 
-    free(base->digits);
-
-    base->digits = result.digits; 
-    base->length = resultSize;
-    base->negative = base->negative != factor.negative;
-    RemoveHeadZeros(base);
+    result.negative = base->negative != factor.negative;
+    BcFreeIntExt(*base);
+    *base = result;
+    BcRemoveHeadZeros(base);
 }
 
 // Calculate (base)+(term)
 // Result is stored in base
-void Add(IntExt *base, IntExt term) {
+void BcAdd(IntExt *base, IntExt term) {
+    if (BcIsSmall(*base) && BcIsSmall(term)) {
+        // 64 bits operands : compute with native integers, unless the sum overflows
+        uint64_t a = BcGetSmallValue(*base), b = BcGetSmallValue(term);
+        if (base->negative != term.negative) {
+            if (a < b) {
+                base->negative = term.negative;
+            }
+            BcSetSmallValue(base, a < b ? b - a : a - b);
+            return;
+        }
+        if (a + b >= a) {
+            BcSetSmallValue(base, a + b);
+            return;
+        }
+    }
+
     if (base->negative == term.negative) {
         AddUnsigned(base, term);
     } else {
-        int greaterThan = CompareAbsoluteValue(*base, term);
+        int greaterThan = BcCompareAbsoluteValue(*base, term);
 
         switch (greaterThan) {
             case 1:
@@ -123,16 +194,12 @@ void Add(IntExt *base, IntExt term) {
             break;
 
             case -1:
-            IntExt result = DuplicateIntExt(term);
-            SubUnsigned(&result, *base);
-            FreeIntExt(*base);
-            base->negative = result.negative;
-            base->digits = result.digits;
-            base->length = result.length;
+            SubFromUnsigned(base, term);
+            base->negative = term.negative;
             break;
 
             case 0:
-            Nullify(base);
+            BcNullify(base);
             break;
         }
     }
@@ -140,69 +207,94 @@ void Add(IntExt *base, IntExt term) {
 
 // Calculate (base)-(term)
 // Result is stored in base
-void Sub(IntExt *base, IntExt term) {
+void BcSub(IntExt *base, IntExt term) {
     term.negative = (-1 * term.negative) + 1;
-    Add(base, term);
+    BcAdd(base, term);
 }
 
 // Calculate (base)+(term), ignoring signs
 // Result is stored in base
-void AddUnsigned(IntExt *base, IntExt term) {
+static void AddUnsigned(IntExt *base, IntExt term) {
 // decompose IntExt sum into simpler digit sums.
 // works the same way as hand addition (don't forget the carry)
-// note : may reserve 1 digit more than needed, that won't be integrated in intExt length
-    int resultSize;
-    if (base->length > term.length) {
-        resultSize = base->length + 1;
-    } else {
-        resultSize = term.length + 1;
+// digits of base are updated in place : base is only extended when term is longer or when a carry remains
+    if (base->length < term.length) {
+        BcResizeIntExt(base, term.length);
     }
-    uint32_t *result = malloc(sizeof(uint32_t) * resultSize);
+    uint32_t *baseDigits = GetDigits(base), *termDigits = GetDigits(&term);
 
     uint64_t carry = 0;
+    int i;
 
-    for (int i = 0; i < resultSize; i++) {
-        uint64_t digit = (uint64_t) GetDigit(*base, i) + (uint64_t) GetDigit(term, i) + carry;
-        result[i] = (uint32_t) digit;
+    for (i = 0; i < term.length; i++) {
+        uint64_t digit = (uint64_t) baseDigits[i] + (uint64_t) termDigits[i] + carry;
+        baseDigits[i] = (uint32_t) digit;
         carry = digit >> 32;
     }
+    for (; carry != 0 && i < base->length; i++) {
+        baseDigits[i]++;
+        carry = baseDigits[i] == 0;
+    }
 
-    free(base->digits);
+    if (carry != 0) {
+        BcResizeIntExt(base, base->length + 1);
+        GetDigits(base)[base->length - 1] = 1;
+    }
 
-    // reduce length if last digit is 0
-    base->digits = result;
-    base->length = resultSize;
-    RemoveHeadZeros(base);
+    BcRemoveHeadZeros(base);
 }
 
 // Calculate (base)-(term), ignoring signs
 // Result is stored in base
 // Base should be greater in absolute value than term
-void SubUnsigned(IntExt *base, IntExt term) {
+static void SubUnsigned(IntExt *base, IntExt term) {
+    uint32_t *digits = GetDigits(base), *termDigits = GetDigits(&term);
     uint32_t carry = 0;
     int i = 0;
     while (i < term.length || carry) {
-        uint32_t termDigit = GetDigit(term, i);
-        uint32_t nextCarry = base->digits[i] < (termDigit + carry);
-        base->digits[i] -= termDigit + carry;
+        uint32_t termDigit = i < term.length ? termDigits[i] : 0;
+        // compare without computing (termDigit + carry), which overflows for termDigit = 2^32 - 1
+        uint32_t nextCarry = digits[i] < termDigit || (digits[i] == termDigit && carry);
+        digits[i] -= termDigit + carry;
         carry = nextCarry;
         i++;
     }
 
-    RemoveHeadZeros(base);
+    BcRemoveHeadZeros(base);
+}
+
+// Calculate (term)-(base), ignoring signs
+// Result is stored in base, extended to term length
+// Term should be greater in absolute value than base
+static void SubFromUnsigned(IntExt *base, IntExt term) {
+    int length = base->length;
+    BcResizeIntExt(base, term.length);
+    uint32_t *digits = GetDigits(base), *termDigits = GetDigits(&term);
+
+    uint32_t carry = 0;
+    for (int i = 0; i < term.length; i++) {
+        uint32_t digit = i < length ? digits[i] : 0;
+        // compare without computing (digit + carry), which overflows for digit = 2^32 - 1
+        uint32_t nextCarry = termDigits[i] < digit || (termDigits[i] == digit && carry);
+        digits[i] = termDigits[i] - digit - carry;
+        carry = nextCarry;
+    }
+
+    BcRemoveHeadZeros(base);
 }
 
 // Returns  1 if |a| > |b|
 // Returns -1 if |a| < |b|
 // Returns  0 if |a| = |b|
-int CompareAbsoluteValue(IntExt a, IntExt b) {
+int BcCompareAbsoluteValue(IntExt a, IntExt b) {
     int result = Compare32(a.length, b.length);
     if (result != 0) {
         return result;
     }
 
+    uint32_t *aDigits = GetDigits(&a), *bDigits = GetDigits(&b);
     for (int i = a.length - 1; i >= 0; i--) {
-        result = Compare32(a.digits[i], b.digits[i]);
+        result = Compare32(aDigits[i], bDigits[i]);
         if (result != 0) {
             return result;
         }
@@ -214,7 +306,7 @@ int CompareAbsoluteValue(IntExt a, IntExt b) {
 // Returns  1 if a > b
 // Returns -1 if a < b
 // Returns  0 if a = b
-int Compare32(uint32_t a, uint32_t b) {
+static int Compare32(uint32_t a, uint32_t b) {
     if (a > b) {
         return 1;
     }
@@ -226,94 +318,420 @@ int Compare32(uint32_t a, uint32_t b) {
     return 0;
 }
 
-// Calculate (base)/(term)
-// Result is stored in base
-void Divide(IntExt *base, IntExt dividend) {
+// Calculate (base)/(dividend)
+// Result is stored in base. Returns error code if dividend is zero
+int BcDivide(IntExt *base, IntExt dividend) {
+    uint64_t profileStart = BcProfileStart();
+    int operandLength = base->length;
+
+    int error = BcEuclideanDivision(base, dividend, NULL);
+
+    BcProfileStop(PROFILE_DIVIDE, profileStart, operandLength);
+
+    return error;
+}
+
+// Calculate (base)%(modulus), rest of the division of base by modulus
+// Result has the sign of base, so that base = (base/modulus)*modulus + (base%modulus)
+// Result is stored in base. Returns error code if modulus is zero
+int BcModulo(IntExt *base, IntExt modulus) {
+    uint64_t profileStart = BcProfileStart();
+    int operandLength = base->length;
+
+    IntExt rest;
+    int error = BcEuclideanDivision(base, modulus, &rest);
+
+    if (error == BIGCALC_OK) {
+        BcFreeIntExt(*base);
+        *base = rest;
+    }
+
+    BcProfileStop(PROFILE_DIVIDE, profileStart, operandLength);
+
+    return error;
+}
+
+// Calculate (base)/(dividend), quotient is stored in base
+// If rest is not NULL, it is set to the rest of the division, with the sign of base
+// Returns error code if dividend is zero
+int BcEuclideanDivision(IntExt *base, IntExt dividend, IntExt *rest) {
     // decompose IntExt division into simpler divisions with single digit result
     // works the same as hand euclidian division
+    if (BcIsZero(dividend)) {
+        return BIGCALC_ERROR_DIVISION_BY_ZERO;
+    }
 
-    if (CompareAbsoluteValue(*base, dividend) == -1) {
-        Nullify(base);
-        return;
+    int negative = base->negative != dividend.negative;
+
+    if (BcIsSmall(*base) && BcIsSmall(dividend)) {
+        // 64 bits operands : divide with native integers
+        uint64_t a = BcGetSmallValue(*base), b = BcGetSmallValue(dividend);
+        if (rest != NULL) {
+            *rest = BcInitiateIntExt(0, base->negative);
+            BcSetSmallValue(rest, a % b);
+        }
+        BcSetSmallValue(base, a / b);
+        base->negative = negative;
+        BcRemoveHeadZeros(base);
+        return BIGCALC_OK;
+    }
+
+    if (BcCompareAbsoluteValue(*base, dividend) == -1) {
+        if (rest != NULL) {
+            *rest = BcDuplicateIntExt(*base);
+        }
+        BcNullify(base);
+        return BIGCALC_OK;
+    }
+
+    int64_t rank = GetPowerOfTwoRank(dividend);
+
+    if (rank >= 0) {
+        // rest is made of the (rank) lowest bits, quotient of the other ones
+        if (rest != NULL) {
+            // only digits holding the lowest bits are copied
+            int restLength = (int) (rank / 32) + 1;
+            *rest = BcAllocateIntExt(restLength);
+            rest->negative = base->negative;
+            for (int i = 0; i < restLength; i++) {
+                GetDigits(rest)[i] = GetDigits(base)[i];
+            }
+            KeepLowestBits(rest, rank);
+        }
+        ShiftRightBits(base, rank);
+        base->negative = negative;
+        BcRemoveHeadZeros(base);
+        return BIGCALC_OK;
+    }
+
+    if (dividend.length == 1) {
+        uint32_t restDigit = BcSingleDigitDivide(base, GetDigits(&dividend)[0]);
+        if (rest != NULL) {
+            *rest = BcInitiateIntExt(restDigit, base->negative);
+            BcRemoveHeadZeros(rest);
+        }
+        base->negative = negative;
+        BcRemoveHeadZeros(base);
+        return BIGCALC_OK;
+    }
+
+    // normalize operands : shift both of them until dividend most significant digit has its highest bit set
+    // quotient is unchanged and rest is shifted, it will be shifted back at the end
+    // ProcessDivision can then estimate each quotient digit from most significant digits only
+    // numerator is not copied : its digits are read shifted on the fly, and each quotient digit replaces
+    // a numerator digit that is not read anymore, so that base is divided in place
+    int shift = 0;
+    while ((GetDigits(&dividend)[dividend.length - 1] << shift) < 0x80000000u) {
+        shift++;
+    }
+    // dividend is copied when it has to be shifted, or when it shares its digits with base
+    IntExt divisor = dividend;
+    int divisorCopied = shift != 0 || dividend.allocatedDigits == base->allocatedDigits;
+    if (divisorCopied) {
+        divisor = BcDuplicateIntExt(dividend);
+        ShiftLeftBits(&divisor, shift);
+    }
+
+    uint32_t *numeratorDigits = GetDigits(base);
+    int numeratorLength = base->length;
+    if (GetShiftedDigit(numeratorDigits, base->length, base->length, shift) != 0) {
+        numeratorLength++;
     }
 
-    int resultSize = base->length - dividend.length + 1;
-    IntExt result = InitiateIntExtZero(resultSize);
+    int resultSize = numeratorLength - divisor.length + 1;
 
-    // initiate subquotient from most significant digits of base
-    // subquotients lengths can be (dividend.length) or (dividend.length + 1)
-    IntExt subQuotient = InitiateIntExtZero(dividend.length + 1);
-    for (int i = 0; i < dividend.length; i++) {
-        subQuotient.digits[i] = base->digits[base->length - dividend.length + i];
+    // initiate subquotient from most significant digits of numerator
+    // subquotients lengths can be (divisor.length) or (divisor.length + 1)
+    IntExt subQuotient = BcInitiateIntExtZero(divisor.length + 1);
+    uint32_t *subQuotientDigits = GetDigits(&subQuotient);
+    for (int i = 0; i < divisor.length; i++) {
+        subQuotientDigits[i] = GetShiftedDigit(numeratorDigits, base->length, numeratorLength - divisor.length + i, shift);
     }
-    subQuotient.length--;   // only (dividend.length) digits used here
+    subQuotient.length--;   // only (divisor.length) digits used here
+    BcRemoveHeadZeros(&subQuotient);
 
-    int lastDigitProcessed = base->length - dividend.length - 1;    // last base digit processed
+    // products of divisor by quotient digits, reused for each digit
+    IntExt subMult = BcAllocateIntExt(divisor.length + 1);
+
+    int lastDigitProcessed = numeratorLength - divisor.length - 1;    // last numerator digit processed
 
     for (int i = resultSize - 1; i >= 0; i--) {
         // find next digit and update subquotient
-        result.digits[i] = ProcessDivision(&subQuotient, dividend);
+        // numerator digits of rank i and more are already processed : quotient digit can replace digit of rank i
+        uint32_t digit = ProcessDivision(&subQuotient, divisor, &subMult);
         if (lastDigitProcessed >= 0) {
             // compute next subquotient
             // shift all digits and use digit of rank lastDigitProcessed as least significant digit
-            for (int j = dividend.length; j >= 1; j--) {
-                subQuotient.digits[j] = subQuotient.digits[j-1];
+            for (int j = divisor.length; j >= 1; j--) {
+                subQuotientDigits[j] = j - 1 < subQuotient.length ? subQuotientDigits[j - 1] : 0;
             }
-            subQuotient.digits[0] = base->digits[lastDigitProcessed];
+            subQuotientDigits[0] = GetShiftedDigit(numeratorDigits, base->length, lastDigitProcessed, shift);
             lastDigitProcessed--;
 
             // make sure length is properly set
-            subQuotient.length = dividend.length + 1;
-            RemoveHeadZeros(&subQuotient);
+            subQuotient.length = divisor.length + 1;
+            BcRemoveHeadZeros(&subQuotient);
         }
+        numeratorDigits[i] = digit;
+    }
+
+    // after last digit, subquotient contains the (shifted) rest of the division
+    if (rest != NULL) {
+        *rest = subQuotient;
+        ShiftRightBits(rest, shift);
+        rest->negative = base->negative;
+        BcRemoveHeadZeros(rest);
+    } else {
+        BcFreeIntExt(subQuotient);
+    }
+
+    BcFreeIntExt(subMult);
+    if (divisorCopied) {
+        BcFreeIntExt(divisor);
     }
 
-    FreeIntExt(subQuotient);
-    free(base->digits);
-    base->digits = result.digits;
-    base->length = result.length;
-    base->negative = base->negative != dividend.negative;
-    RemoveHeadZeros(base);
+    base->length = resultSize;
+    base->negative = negative;
+    BcRemoveHeadZeros(base);
+
+    return BIGCALC_OK;
+}
+
+// Return digit of given rank in (digits << shift), digits being an array of given length and shift lower than 32
+static uint32_t GetShiftedDigit(uint32_t *digits, int length, int rank, int shift) {
+    uint32_t result = rank < length ? digits[rank] << shift : 0;
+
+    if (shift != 0 && rank > 0 && rank - 1 < length) {
+        result |= digits[rank - 1] >> (32 - shift);
+    }
+
+    return result;
 }
 
 // returns the greatest int p such as (p * dividend) <= quotient
 // quotient is updated with the rest of the division : quotient = quotient - (p * dividend)
-uint32_t ProcessDivision(IntExt *quotient, IntExt dividend) {
-    uint32_t result = 0;
-    int bitRank = 31;
-
-    uint32_t subResult;
-    IntExt subMult;
-
-    // test result's bits one by one
-    while (bitRank >= 0) {;
-        subResult = result + (1 << bitRank);
-        subMult = SingleDigitMultiply(dividend, subResult);
-        if (CompareAbsoluteValue(subMult, *quotient) <= 0) {
-            result = subResult;
-        }
-        bitRank--;
-        FreeIntExt(subMult);
+// dividend should be normalized (highest bit of its most significant digit set)
+// and quotient lower than (dividend * 2^32)
+// subMult is a buffer of (dividend.length + 1) digits, reused by each call
+static uint32_t ProcessDivision(IntExt *quotient, IntExt dividend, IntExt *subMult) {
+    // estimate p by dividing the two most significant digits of quotient by the most significant digit of dividend
+    // as dividend is normalized, estimation is never lower than p and at most 2 over it
+    int n = dividend.length;
+    uint64_t head = ((uint64_t) BcGetDigit(*quotient, n) << 32) | (uint64_t) BcGetDigit(*quotient, n - 1);
+    uint64_t estimate = head / GetDigits(&dividend)[n - 1];
+    if (estimate > UINT32_MAX) {
+        estimate = UINT32_MAX;
     }
 
-    subMult = SingleDigitMultiply(dividend, result);
-    SubUnsigned(quotient, subMult);
-    FreeIntExt(subMult);
+    uint32_t result = (uint32_t) estimate;
+    WriteSingleDigitProduct(dividend, result, subMult);
+
+    while (BcCompareAbsoluteValue(*subMult, *quotient) > 0) {
+        result--;
+        SubUnsigned(subMult, dividend);
+    }
+
+    SubUnsigned(quotient, *subMult);
 
     return result;
 }
 
 // Returns digit * intExt
-IntExt SingleDigitMultiply(IntExt intExt, uint32_t digit) {
-    IntExt result = InitiateIntExtZero(intExt.length + 1);
+static IntExt SingleDigitMultiply(IntExt intExt, uint32_t digit) {
+    IntExt result = BcAllocateIntExt(intExt.length + 1);
+    WriteSingleDigitProduct(intExt, digit, &result);
+
+    return result;
+}
+
+// Store digit * intExt absolute value in result, whose digits can hold (intExt.length + 1) digits
+static void WriteSingleDigitProduct(IntExt intExt, uint32_t digit, IntExt *result) {
+    uint32_t *resultDigits = GetDigits(result), *digits = GetDigits(&intExt);
     uint64_t carry = 0;
 
-    for (int i = 0; i <= intExt.length; i++) {
-        uint64_t mult = (uint64_t) digit * (uint64_t) GetDigit(intExt, i) + carry; 
-        result.digits[i] = (uint32_t) mult;
+    for (int i = 0; i < intExt.length; i++) {
+        uint64_t mult = (uint64_t) digit * (uint64_t) digits[i] + carry; 
+        resultDigits[i] = (uint32_t) mult;
         carry = (uint32_t) (mult >> 32);
     }
+    resultDigits[intExt.length] = (uint32_t) carry;
+
+    result->length = intExt.length + 1;
+    BcRemoveHeadZeros(result);
+}
+// Calculate (base)/(digit), ignoring signs
+// Quotient is stored in base, returns the rest
+uint32_t BcSingleDigitDivide(IntExt *base, uint32_t digit) {
+// each step divides a two digits number (rest, next digit) by digit, using a precomputed reciprocal
+// of digit instead of a hardware division (Moller & Granlund, "Improved division by invariant integers")
+// digit is normalized (shifted until its most significant bit is set), base is shifted accordingly on the fly
+    int shift = 0;
+    while ((digit << shift) < 0x80000000u) {
+        shift++;
+    }
+    uint32_t normalized = digit << shift;
+    uint32_t reciprocal = (uint32_t) (UINT64_MAX / normalized - ((uint64_t) 1 << 32));
+    uint32_t *digits = GetDigits(base);
+
+    // bits of base shifted out of the most significant digit form the first rest
+    uint32_t rest = shift == 0 ? 0 : digits[base->length - 1] >> (32 - shift);
+
+    for (int i = base->length - 1; i >= 0; i--) {
+        uint32_t next = digits[i] << shift;
+        if (shift != 0 && i > 0) {
+            next |= digits[i - 1] >> (32 - shift);
+        }
+
+        // estimate quotient digit from (rest, next), then correct it at most twice
+        uint64_t estimate = (uint64_t) reciprocal * rest + (((uint64_t) rest << 32) | next);
+        uint32_t quotientDigit = (uint32_t) (estimate >> 32) + 1;
+        uint32_t remainder = next - quotientDigit * normalized;
+        if (remainder > (uint32_t) estimate) {
+            quotientDigit--;
+            remainder += normalized;
+        }
+        if (remainder >= normalized) {
+            quotientDigit++;
+            remainder -= normalized;
+        }
+
+        digits[i] = quotientDigit;
+        rest = remainder;
+    }
+
+    BcRemoveHeadZeros(base);
+
+    return rest >> shift;
+}
+
+// Returns n if |intExt| = 2^n, -1 if |intExt| is not a power of two
+static int64_t GetPowerOfTwoRank(IntExt intExt) {
+    uint32_t *digits = GetDigits(&intExt);
+    for (int i = 0; i < intExt.length - 1; i++) {
+        if (digits[i] != 0) {
+            return -1;
+        }
+    }
+
+    uint32_t head = digits[intExt.length - 1];
+    if (head == 0 || (head & (head - 1)) != 0) {
+        return -1;
+    }
+
+    int64_t result = (int64_t) (intExt.length - 1) * 32;
+    while (head > 1) {
+        head = head >> 1;
+        result++;
+    }
 
-    RemoveHeadZeros(&result);
     return result;
-}
\ No newline at end of file
+}
+
+// Calculate (base)<<(shift) : multiply base by 2^shift
+// Result is stored in base. Returns error code if shift is negative or too large
+int BcShiftLeft(IntExt *base, IntExt shift) {
+    if (shift.length != 1) {
+        return BIGCALC_ERROR_SHIFT_RANGE;
+    }
+
+    if (shift.negative) {
+        return BIGCALC_ERROR_NEGATIVE_SHIFT;
+    }
+
+    ShiftLeftBits(base, GetDigits(&shift)[0]);
+
+    return BIGCALC_OK;
+}
+
+// Calculate (base)>>(shift) : divide base by 2^shift
+// Result is stored in base. Returns error code if shift is negative or too large
+int BcShiftRight(IntExt *base, IntExt shift) {
+    if (shift.length != 1) {
+        return BIGCALC_ERROR_SHIFT_RANGE;
+    }
+
+    if (shift.negative) {
+        return BIGCALC_ERROR_NEGATIVE_SHIFT;
+    }
+
+    ShiftRightBits(base, GetDigits(&shift)[0]);
+
+    return BIGCALC_OK;
+}
+
+// Multiply absolute value of intExt by 2^bits
+// Digits are moved in place, from the most significant one, after extending intExt
+static void ShiftLeftBits(IntExt *intExt, int64_t bits) {
+    if (BcIsZero(*intExt)) {
+        intExt->negative = 0;
+        return;
+    }
+
+    int digitShift = (int) (bits / 32);
+    int bitShift = (int) (bits % 32);
+    int length = intExt->length;
+    BcResizeIntExt(intExt, length + digitShift + 1);
+    uint32_t *digits = GetDigits(intExt);
+
+    digits[length + digitShift] = bitShift == 0 ? 0 : digits[length - 1] >> (32 - bitShift);
+    for (int i = length - 1; i >= 0; i--) {
+        uint32_t digit = digits[i] << bitShift;
+        if (bitShift != 0 && i > 0) {
+            digit |= digits[i - 1] >> (32 - bitShift);
+        }
+        digits[digitShift + i] = digit;
+    }
+
+    for (int i = 0; i < digitShift; i++) {
+        digits[i] = 0;
+    }
+
+    BcRemoveHeadZeros(intExt);
+}
+
+// Divide absolute value of intExt by 2^bits, rounding toward zero
+static void ShiftRightBits(IntExt *intExt, int64_t bits) {
+    if (bits >= (int64_t) intExt->length * 32) {
+        BcNullify(intExt);
+        return;
+    }
+
+    int digitShift = (int) (bits / 32);
+    int bitShift = (int) (bits % 32);
+    int resultSize = intExt->length - digitShift;
+    uint32_t *digits = GetDigits(intExt);
+
+    for (int i = 0; i < resultSize; i++) {
+        uint32_t digit = digits[digitShift + i] >> bitShift;
+        if (bitShift != 0 && digitShift + i + 1 < intExt->length) {
+            digit |= digits[digitShift + i + 1] << (32 - bitShift);
+        }
+        digits[i] = digit;
+    }
+
+    intExt->length = resultSize;
+    BcRemoveHeadZeros(intExt);
+}
+
+// Keep only the (bits) lowest bits of intExt absolute value
+static void KeepLowestBits(IntExt *intExt, int64_t bits) {
+    if (bits >= (int64_t) intExt->length * 32) {
+        return;
+    }
+
+    int length = (int) (bits / 32);
+    int bitCount = (int) (bits % 32);
+
+    if (bitCount != 0) {
+        GetDigits(intExt)[length] &= (1u << bitCount) - 1;
+        length++;
+    }
+
+    if (length == 0) {
+        BcNullify(intExt);
+        return;
+    }
+
+    intExt->length = length;
+    BcRemoveHeadZeros(intExt);
+}
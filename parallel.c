@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "header.h"
+
+// Parallel evaluation of RPN expressions : each token is a task, that can run once its operands are computed.
+// Independent subexpressions, such as both sides of (3^4000000 + 1) * (5^3000000 - 7), are computed by different threads.
+//
+// Ready operations are kept in one deque per worker. A worker runs its most recent task first (depth first, like
+// the sequential evaluation, so that few values are alive at once), and steals the oldest task of another worker
+// when its deque is empty. Tasks are big number operations, so deques are protected by a single pool lock.
+//
+// Numbers are converted in expression order, when a worker has no operation to run. Values computed ahead of
+// the sequential evaluation (after the first task not computed yet) are kept until the evaluation reaches them :
+// big numbers are only converted ahead while fewer than (jobs) allocated values are held ahead, so that memory
+// stays bounded by sequential evaluation memory and (jobs) values. Operations never add values ahead, as they
+// free their operands.
+
+#define SMALL_NUMBER_LENGTH 19  // numbers of at most 19 decimal characters fit in 64 bits, and are not allocated
+
+// Node of expression tree
+typedef struct Task {
+    Token token;
+    int operands[3];    // tasks computing operands, in RPN order
+    int operandCount;
+    int parent;         // task using this value, -1 for expression result
+    int pending;        // operands not computed yet
+    int computed;       // 1 once value is set, until parent uses it
+    int done;           // 1 once value is set
+    int ahead;          // 1 if task is counted in aheadCount
+    IntExt value;
+} Task;
+
+// Ready tasks of a worker : owner pushes and pops at bottom, thieves take from top
+typedef struct Deque {
+    int *tasks;
+    int top;
+    int bottom;
+} Deque;
+
+typedef struct Pool {
+    Task *tasks;
+    int taskCount;
+
+    Deque *deques;
+    int workerCount;
+    int readyCount;             // tasks in all deques
+
+    int nextNumber;             // next number to convert, in expression order
+    int front;                  // first task not computed yet : tasks before it are computed, as in sequential evaluation
+    int aheadCount;             // allocated values after front, computed or being computed
+    int aheadLimit;
+
+    pthread_mutex_t lock;       // protects deques, task counters and pool state
+    pthread_cond_t taskReady;
+    int finished;               // 1 when result is computed or an operation failed
+    int error;
+} Pool;
+
+// Argument of worker threads
+typedef struct Worker {
+    Pool *pool;
+    int rank;
+} Worker;
+
+static void BuildTasks(Pool *pool, Rpn rpn);
+static void FreePool(Pool *pool, int jobs);
+static void *RunWorker(void *argument);
+static int TakeTask(Pool *pool, int rank);
+static int TakeNumber(Pool *pool);
+static void StartTask(Pool *pool, int rank);
+static void FinishTask(Pool *pool, int rank);
+static void PushTask(Pool *pool, int rank, int task);
+static int ComputeTask(Pool *pool, Task *task);
+
+
+// Compute value of RPN expression with (jobs) threads, stored in (result)
+// Expression should be valid, as returned by BcParseRpn
+// Returns error code of the first operation that fails, in which case nothing is left allocated
+int BcEvaluateRpnParallel(Rpn rpn, int jobs, IntExt *result) {
+    if (jobs <= 1) {
+        return BcEvaluateRpn(rpn, result);
+    }
+
+    uint64_t profileStart = BcProfileStart();
+
+    Pool pool;
+    BuildTasks(&pool, rpn);
+    pool.workerCount = jobs;
+    pool.readyCount = 0;
+    pool.nextNumber = 0;
+    pool.front = 0;
+    pool.aheadCount = 0;
+    pool.aheadLimit = jobs;
+    pool.finished = 0;
+    pool.error = BIGCALC_OK;
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.taskReady, NULL);
+
+    pool.deques = malloc(sizeof(Deque) * jobs);
+    for (int i = 0; i < jobs; i++) {
+        pool.deques[i].tasks = malloc(sizeof(int) * pool.taskCount);
+        pool.deques[i].top = 0;
+        pool.deques[i].bottom = 0;
+    }
+
+    pthread_t *threads = malloc(sizeof(pthread_t) * jobs);
+    Worker *workers = malloc(sizeof(Worker) * jobs);
+
+    // workers wait for the lock until the number of threads actually created is known
+    pthread_mutex_lock(&pool.lock);
+    int created = 0;
+    while (created < jobs) {
+        workers[created].pool = &pool;
+        workers[created].rank = created;
+        if (pthread_create(&threads[created], NULL, RunWorker, &workers[created]) != 0) {
+            break;
+        }
+        created++;
+    }
+    pool.workerCount = created;
+    pool.aheadLimit = created;
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int i = 0; i < created; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    free(workers);
+
+    // no thread could be created : nothing was computed
+    if (created == 0) {
+        FreePool(&pool, jobs);
+        return BcEvaluateRpn(rpn, result);
+    }
+
+    int error = pool.error;
+    if (error == BIGCALC_OK) {
+        *result = pool.tasks[pool.taskCount - 1].value;
+    } else {
+        // free values computed before the failure
+        for (int i = 0; i < pool.taskCount; i++) {
+            if (pool.tasks[i].computed) {
+                BcFreeIntExt(pool.tasks[i].value);
+            }
+        }
+    }
+
+    FreePool(&pool, jobs);
+
+    if (error == BIGCALC_OK) {
+        BcProfileStop(PROFILE_EVALUATION, profileStart, result->length);
+    }
+
+    return error;
+}
+
+// Return number of processors available, used as default number of jobs
+int BcGetProcessorCount() {
+    long result = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return result < 1 ? 1 : (int) result;
+}
+
+// Build expression tree from RPN expression, by simulating its evaluation stack
+// Last task computes expression result
+static void BuildTasks(Pool *pool, Rpn rpn) {
+    pool->tasks = malloc(sizeof(Task) * rpn.length);
+    pool->taskCount = rpn.length;
+
+    // RPN stack can't be deeper than expression length
+    int *stack = malloc(sizeof(int) * (rpn.length + 1));
+    int depth = 0;
+
+    for (int i = 0; i < rpn.length; i++) {
+        Task *task = &pool->tasks[i];
+        task->token = rpn.tokens[i];
+        task->operandCount = 0;
+        task->parent = -1;
+        task->computed = 0;
+        task->done = 0;
+        task->ahead = 0;
+
+        if (task->token.operator != 0) {
+            task->operandCount = task->token.operator == POWER_MODULO_OPERATOR ? 3 : 2;
+            depth -= task->operandCount;
+            for (int j = 0; j < task->operandCount; j++) {
+                task->operands[j] = stack[depth + j];
+                pool->tasks[stack[depth + j]].parent = i;
+            }
+        }
+        task->pending = task->operandCount;
+
+        stack[depth] = i;
+        depth++;
+    }
+
+    free(stack);
+}
+
+// Free tasks, deques and synchronization objects of pool, created for (jobs) workers
+static void FreePool(Pool *pool, int jobs) {
+    for (int i = 0; i < jobs; i++) {
+        free(pool->deques[i].tasks);
+    }
+    free(pool->deques);
+    free(pool->tasks);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->taskReady);
+}
+
+// Run tasks until expression is computed
+static void *RunWorker(void *argument) {
+    Worker *worker = argument;
+    Pool *pool = worker->pool;
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (!pool->finished) {
+        int rank = TakeTask(pool, worker->rank);
+        if (rank < 0) {
+            pthread_cond_wait(&pool->taskReady, &pool->lock);
+            continue;
+        }
+
+        // operands are not used by any other task : operation runs without lock
+        Task *task = &pool->tasks[rank];
+        StartTask(pool, rank);
+        pthread_mutex_unlock(&pool->lock);
+        int error = ComputeTask(pool, task);
+        pthread_mutex_lock(&pool->lock);
+
+        task->computed = 1;
+        for (int i = 0; i < task->operandCount; i++) {
+            pool->tasks[task->operands[i]].computed = 0;
+        }
+        FinishTask(pool, rank);
+
+        if (error != BIGCALC_OK) {
+            if (pool->error == BIGCALC_OK) {
+                pool->error = error;
+            }
+            pool->finished = 1;
+            pthread_cond_broadcast(&pool->taskReady);
+        } else if (task->parent < 0) {
+            pool->finished = 1;
+            pthread_cond_broadcast(&pool->taskReady);
+        } else {
+            Task *parent = &pool->tasks[task->parent];
+            parent->pending--;
+            if (parent->pending == 0) {
+                // parent is run next by the same worker, while its operands are in cache
+                PushTask(pool, worker->rank, task->parent);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+// Return a ready task : operation from worker's own deque, next number, or operation stolen from another worker
+// Returns -1 if there is none
+// Pool should be locked
+static int TakeTask(Pool *pool, int rank) {
+    Deque *own = &pool->deques[rank];
+    if (own->bottom > own->top) {
+        pool->readyCount--;
+        own->bottom--;
+        return own->tasks[own->bottom];
+    }
+
+    int number = TakeNumber(pool);
+    if (number >= 0 || pool->readyCount == 0) {
+        return number;
+    }
+
+    for (int i = 1; i < pool->workerCount; i++) {
+        Deque *victim = &pool->deques[(rank + i) % pool->workerCount];
+        if (victim->bottom > victim->top) {
+            pool->readyCount--;
+            victim->top++;
+            return victim->tasks[victim->top - 1];
+        }
+    }
+
+    return -1;
+}
+
+// Return next number of expression, -1 if there is none or if it would exceed the limit of values held ahead
+// Number at front is always returned, so that evaluation progresses
+// Pool should be locked
+static int TakeNumber(Pool *pool) {
+    while (pool->nextNumber < pool->taskCount && pool->tasks[pool->nextNumber].operandCount != 0) {
+        pool->nextNumber++;
+    }
+    if (pool->nextNumber == pool->taskCount) {
+        return -1;
+    }
+
+    int number = pool->nextNumber;
+    int small = pool->tasks[number].token.length <= SMALL_NUMBER_LENGTH;
+    if (number > pool->front && !small && pool->aheadCount >= pool->aheadLimit) {
+        return -1;
+    }
+
+    pool->nextNumber++;
+    return number;
+}
+
+// Count value of task as held ahead if it is, before the task is computed
+// Operands, that are freed by the task, are not held anymore
+// Pool should be locked
+static void StartTask(Pool *pool, int rank) {
+    Task *task = &pool->tasks[rank];
+
+    for (int i = 0; i < task->operandCount; i++) {
+        Task *operand = &pool->tasks[task->operands[i]];
+        if (operand->ahead) {
+            operand->ahead = 0;
+            pool->aheadCount--;
+        }
+    }
+
+    if (rank > pool->front && (task->operandCount != 0 || task->token.length > SMALL_NUMBER_LENGTH)) {
+        task->ahead = 1;
+        pool->aheadCount++;
+    }
+}
+
+// Update front and values held ahead once task is computed, waking up workers if a number can be converted
+// Pool should be locked
+static void FinishTask(Pool *pool, int rank) {
+    Task *task = &pool->tasks[rank];
+    int aheadCount = pool->aheadCount;
+    int front = pool->front;
+
+    task->done = 1;
+    if (task->ahead && task->value.allocatedDigits == NULL) {
+        task->ahead = 0;
+        pool->aheadCount--;
+    }
+
+    // values before front are held by sequential evaluation too
+    while (pool->front < pool->taskCount && pool->tasks[pool->front].done) {
+        if (pool->tasks[pool->front].ahead) {
+            pool->tasks[pool->front].ahead = 0;
+            pool->aheadCount--;
+        }
+        pool->front++;
+    }
+
+    if (pool->aheadCount < aheadCount || pool->front > front) {
+        pthread_cond_broadcast(&pool->taskReady);
+    }
+}
+
+// Add ready task at bottom of worker's deque, and wake up an idle worker
+// Pool should be locked
+static void PushTask(Pool *pool, int rank, int task) {
+    Deque *deque = &pool->deques[rank];
+
+    // each task is pushed once : deque can be reset when empty instead of wrapping around
+    if (deque->top == deque->bottom) {
+        deque->top = 0;
+        deque->bottom = 0;
+    }
+    deque->tasks[deque->bottom] = task;
+    deque->bottom++;
+
+    pool->readyCount++;
+    pthread_cond_signal(&pool->taskReady);
+}
+
+// Compute value of task from values of its operands, that are freed
+// Returns error code of the operation
+static int ComputeTask(Pool *pool, Task *task) {
+    if (task->operandCount == 0) {
+        task->value = BcConvertNumber(task->token);
+        return BIGCALC_OK;
+    }
+
+    IntExt base = pool->tasks[task->operands[0]].value;
+    IntExt operand = pool->tasks[task->operands[task->operandCount - 1]].value;
+    int error;
+
+    if (task->token.operator == POWER_MODULO_OPERATOR) {
+        IntExt power = pool->tasks[task->operands[1]].value;
+        error = BcPowerModulo(&base, power, operand);
+        BcFreeIntExt(power);
+    } else {
+        error = BcApplyOperator(task->token.operator, &base, operand);
+    }
+    BcFreeIntExt(operand);
+
+    task->value = base;
+
+    return error;
+}
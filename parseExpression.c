@@ -1,20 +1,8 @@
 #include "header.h"
 #include <stdio.h>
 #include <stdlib.h>
-
-
-// Reverse Polish Notation stack
-// Output of shunting yard algorithm
-typedef struct IntExtList {
-    IntExt value;
-    struct IntExtList *next;
-} IntExtList;
-
-void PushToRpnStack(IntExt value);
-IntExt PopFromRpnStack();
-
-IntExtList *rpnStack;
-
+#include <stdint.h>
+#include <setjmp.h>
 
 // Operator stack of shunting yard algorithm
 typedef struct CharList {
@@ -22,189 +10,192 @@ typedef struct CharList {
     struct CharList *next;
 } CharList;
 
-void PushToOperatorStack(char operator);
-char PopFromOperatorStack();
-
-CharList *operatorStack;
-
-
-// Program input reading
-int currentIndice;
-char *input;
-
-
-void ProceedToken();
-void ProceedOperator(char operator);
-IntExt ReadNumber();
-void ApplyOperation(char operator);
-
-int GetPrecedence(char operator);
-
-void ParsingError(char *msg);
-
-// Main function for parsing program input
-IntExt ParseExpression(char *arg) {
-    // Initiate global values
-    rpnStack = NULL;
-    operatorStack = NULL;
-    currentIndice = 0;
-    input = arg;
+// State of shunting yard algorithm, so that several expressions can be parsed at the same time
+typedef struct Parser {
+    // Output of shunting yard algorithm
+    Rpn output;
+    int outputCapacity;
+    int outputDepth;    // number of values the RPN expression would have on its stack
+
+    CharList *operatorStack;
+
+    // Program input reading : input is read once, from (current) to (end)
+    char *current;
+    char *end;
+
+    // Parsing errors jump back to BcParseRpn
+    jmp_buf errorJump;
+    const char *errorMessage;
+} Parser;
+
+static void PushToOutput(Parser *parser, Token token);
+static void PushOperatorToOutput(Parser *parser, char operator);
+
+static void PushToOperatorStack(Parser *parser, char operator);
+static char PopFromOperatorStack(Parser *parser);
+
+static void ProceedToken(Parser *parser);
+static void ProceedOperator(Parser *parser, char operator);
+static Token ReadNumber(Parser *parser);
+
+static int GetPrecedence(char operator);
+static int ShouldApplyStackOperator(Parser *parser, int precedence);
+
+static void ParsingError(Parser *parser, const char *msg);
+
+// Convert (length) characters of program input into reverse polish notation, with shunting yard algorithm
+// Input does not need to be null terminated, so that it can be a mapped file
+// Number tokens point to input, which should not be freed before RPN expression
+// Returns BIGCALC_ERROR_PARSING if expression is invalid, with a static message in (errorMessage)
+int BcParseRpn(char *arg, size_t length, Rpn *rpn, const char **errorMessage) {
+    // parser is not a local variable, as local variables modified after setjmp are lost by longjmp
+    Parser *parser = malloc(sizeof(Parser));
+    parser->output.tokens = NULL;
+    parser->output.length = 0;
+    parser->outputCapacity = 0;
+    parser->outputDepth = 0;
+    parser->operatorStack = NULL;
+    parser->current = arg;
+    parser->end = arg + length;
+
+    if (setjmp(parser->errorJump) != 0) {
+        while (parser->operatorStack != NULL) {
+            PopFromOperatorStack(parser);
+        }
+        BcFreeRpn(parser->output);
+        *errorMessage = parser->errorMessage;
+        free(parser);
+        return BIGCALC_ERROR_PARSING;
+    }
 
     // Read and proceed every token
-    while (input[currentIndice] != '\0') {
-        ProceedToken();
+    while (parser->current < parser->end) {
+        ProceedToken(parser);
     }
 
-    // Apply remaining operators
-    while (operatorStack != NULL) {
-        if (operatorStack->operator == '(') {
-            ParsingError("unmatching parenthesis");
+    // Output remaining operators
+    while (parser->operatorStack != NULL) {
+        if (parser->operatorStack->operator == '(') {
+            ParsingError(parser, "unmatching parenthesis");
         }
-        ApplyOperation(PopFromOperatorStack());
+        PushOperatorToOutput(parser, PopFromOperatorStack(parser));
     }
 
-    // RPN stack should only contain the result
-    if (rpnStack == NULL || rpnStack->next !=  NULL) {
-        ParsingError("invalid stack after parsing expression");
+    // RPN expression should leave a single value on its stack
+    if (parser->outputDepth != 1) {
+        ParsingError(parser, "invalid stack after parsing expression");
     }
 
-    IntExt result = rpnStack->value;
-    free(rpnStack);
-    return result;
+    *rpn = parser->output;
+    free(parser);
+
+    return BIGCALC_OK;
+}
+
+// Free RPN expression tokens
+void BcFreeRpn(Rpn rpn) {
+    free(rpn.tokens);
 }
 
 // Read and proceed token from input
-void ProceedToken() {
-    char current = input[currentIndice];
-
-    if (current == '\0') {
-        return;
-    } else if (current == ' ') {
-        currentIndice++;
-    } else if (GetPrecedence(current) != -1) {
-        ProceedOperator(current);
-        currentIndice++;
+static void ProceedToken(Parser *parser) {
+    char current = *parser->current;
+
+    if (current == ' ' || current == '\n' || current == '\t' || current == '\r') {
+        // expressions read from files can span several lines
+        parser->current++;
+    } else if (current == '<' || current == '>') {
+        // shift operators are read as << and >>, but stored as a single character
+        if (parser->current + 1 == parser->end || parser->current[1] != current) {
+            ParsingError(parser, "unknown character");
+        }
+        ProceedOperator(parser, current);
+        parser->current += 2;
+    } else if (current != POWER_MODULO_OPERATOR && GetPrecedence(current) != -1) {
+        ProceedOperator(parser, current);
+        parser->current++;
     } else {
-        PushToRpnStack(ReadNumber());
+        PushToOutput(parser, ReadNumber(parser));
     }
 
     return;
 }
 
 // Proceed operator according to shunting yard algorithm
-void ProceedOperator(char operator) {
+static void ProceedOperator(Parser *parser, char operator) {
     switch (operator) {
         case '(':
-        PushToOperatorStack(operator);
+        PushToOperatorStack(parser, operator);
         break;
 
         case ')':
-        while (operatorStack->operator != '(') {
-            ApplyOperation(PopFromOperatorStack());
+        while (parser->operatorStack != NULL && parser->operatorStack->operator != '(') {
+            PushOperatorToOutput(parser, PopFromOperatorStack(parser));
         }
-        PopFromOperatorStack();
+        if (parser->operatorStack == NULL) {
+            ParsingError(parser, "unmatching parenthesis");
+        }
+        PopFromOperatorStack(parser);
         break;
 
         default:
         int currentPrecedence = GetPrecedence(operator);
-        while (operatorStack != NULL
-                && operatorStack->operator != '('
-                && GetPrecedence(operatorStack->operator) >= currentPrecedence
-                ) {
-            ApplyOperation(PopFromOperatorStack());
+        while (ShouldApplyStackOperator(parser, currentPrecedence)) {
+            char stackOperator = PopFromOperatorStack(parser);
+            if (operator == '%' && stackOperator == '^' && !ShouldApplyStackOperator(parser, currentPrecedence)) {
+                // (a^b) is left operand of %, keep a and b in RPN stack to compute (a^b)%m directly
+                operator = POWER_MODULO_OPERATOR;
+                break;
+            }
+            PushOperatorToOutput(parser, stackOperator);
         }
-        PushToOperatorStack(operator);
+        PushToOperatorStack(parser, operator);
         break;
     }
 }
 
-// Read a number from input and convert it to IntExt format.
-IntExt ReadNumber() {
-    int length = 0;
-    int negative = 0;
+// Read a number from input and return its token
+// Digits are not converted or copied here : token points to them
+static Token ReadNumber(Parser *parser) {
+    Token result;
+    result.operator = 0;
+    result.negative = 0;
 
-    if (input[currentIndice] == '~') {
-        negative = 1;
-        currentIndice++;
+    if (*parser->current == '~') {
+        result.negative = 1;
+        parser->current++;
     }
 
-    char current = input[currentIndice];
-
-    while (current >= '0' && current <= '9') {
-        length++;
-        current = input[currentIndice + length];
+    char *digit = parser->current;
+    while (digit < parser->end && *digit >= '0' && *digit <= '9') {
+        digit++;
     }
 
-    if (length == 0) {
-        // ReadNumber is default in ProceedToken, so length = 0 means no valid character was found
-        ParsingError("unknown character");
+    if (digit == parser->current) {
+        // ReadNumber is default in ProceedToken, so no digit means no valid character was found
+        ParsingError(parser, "unknown character");
     }
 
-    // Convert input into IntExt
-    IntExt result = InitiateIntExt(0, 0);
-    IntExt powerOfTen = InitiateIntExt(1, 0);
-    IntExt ten = InitiateIntExt(10, 0);
-
-    for (int i = length - 1; i >= 0; i--) {
-        current = input[currentIndice + i];
-        if (current != '0') {
-            IntExt digit = InitiateIntExt((uint32_t) (current - '0'), 0);
-            Multiply(&digit, powerOfTen);
-            Add(&result, digit);
-            FreeIntExt(digit);
-        }
-        Multiply(&powerOfTen, ten);
+    if (digit - parser->current > INT32_MAX) {
+        ParsingError(parser, "number too long");
     }
 
-    FreeIntExt(powerOfTen);
-    FreeIntExt(ten);
-
-    result.negative = negative;
-
-    currentIndice += length;
+    result.digits = parser->current;
+    result.length = (int) (digit - parser->current);
+    parser->current = digit;
 
     return result;
 }
 
-// Reduce the two values on top of RPN stack by applying given operator
-void ApplyOperation(char operator) {
-    IntExt operand = PopFromRpnStack();
-
-    void (*func)(IntExt*, IntExt);
-
-    if (rpnStack == NULL) {
-        ParsingError("not enough operands in stack");
-    }
-
-    switch(operator) {
-        case '+':
-        func = Add;
-        break;
-
-        case '-':
-        func = Sub;
-        break;
-
-        case '*':
-        func = Multiply;
-        break;
-
-        case '/':
-        func = Divide;
-        break;
-
-        case '^':
-        func = Exponent;
-        break;
-    }
-
-    func(&rpnStack->value, operand);
-    FreeIntExt(operand);
-}
-
 // Return operator precedence for shunting yard algorithm
-int GetPrecedence(char operator) {
+static int GetPrecedence(char operator) {
     switch (operator) {
+        case '<':
+        return 1;
+
+        case '>':
+        return 1;
+
         case '+':
         return 2;
 
@@ -217,6 +208,12 @@ int GetPrecedence(char operator) {
         case '/':
         return 3;
 
+        case '%':
+        return 3;
+
+        case POWER_MODULO_OPERATOR:
+        return 3;
+
         case '^':
         return 4;
 
@@ -231,55 +228,73 @@ int GetPrecedence(char operator) {
     }
 }
 
-// Print message and exit program
-void ParsingError(char *msg) {
-    printf("Parsing error : %s\n", msg);
-    exit(0);
+// Return 1 if operator on top of operator stack should be applied
+// before pushing an operator of given precedence
+static int ShouldApplyStackOperator(Parser *parser, int precedence) {
+    return parser->operatorStack != NULL
+            && parser->operatorStack->operator != '('
+            && GetPrecedence(parser->operatorStack->operator) >= precedence;
 }
 
-// Push value on top of RPN stack
-void PushToRpnStack(IntExt value) {
-    IntExtList *new = malloc(sizeof(IntExtList));
-
-    new->next = rpnStack;
-    rpnStack = new;
-    rpnStack->value = value;
+// Stop parsing : BcParseRpn returns with given message
+static void ParsingError(Parser *parser, const char *msg) {
+    parser->errorMessage = msg;
+    longjmp(parser->errorJump, 1);
 }
 
-// Return value on top of RPN stack and remove it from the stack
-IntExt PopFromRpnStack() {
-    if (rpnStack == NULL) {
-        ParsingError("trying to pop from empty stack");
+// Add token at the end of RPN expression
+static void PushToOutput(Parser *parser, Token token) {
+    if (parser->output.length == parser->outputCapacity) {
+        parser->outputCapacity = parser->outputCapacity == 0 ? 16 : parser->outputCapacity * 2;
+        parser->output.tokens = realloc(parser->output.tokens, sizeof(Token) * parser->outputCapacity);
     }
 
-    IntExt result = rpnStack->value;
-    IntExtList *newStack = rpnStack->next;
-    free(rpnStack);
-    rpnStack = newStack;
+    parser->output.tokens[parser->output.length] = token;
+    parser->output.length++;
 
-    return result;
+    if (token.operator == 0) {
+        parser->outputDepth++;
+    } else {
+        // operator reduces 2 values into 1 (3 values for power modulo)
+        int operandCount = token.operator == POWER_MODULO_OPERATOR ? 3 : 2;
+        if (parser->outputDepth < operandCount) {
+            ParsingError(parser, "not enough operands in stack");
+        }
+        parser->outputDepth -= operandCount - 1;
+    }
+}
+
+// Add operator token at the end of RPN expression
+static void PushOperatorToOutput(Parser *parser, char operator) {
+    Token token;
+    token.operator = operator;
+    token.negative = 0;
+    token.digits = NULL;
+    token.length = 0;
+
+    PushToOutput(parser, token);
 }
 
 // Push oeprator on top of operator stack
-void PushToOperatorStack(char operator) {
+static void PushToOperatorStack(Parser *parser, char operator) {
     CharList *element = malloc(sizeof(CharList));
 
     element->operator = operator;
-    element->next = operatorStack;
+    element->next = parser->operatorStack;
 
-    operatorStack = element;
+    parser->operatorStack = element;
 }
 
 // Return value on top of oeprator stack and remove it from the stack
-char PopFromOperatorStack() {
-    if (operatorStack == NULL) {
-        ParsingError("empty operator stack");
+static char PopFromOperatorStack(Parser *parser) {
+    if (parser->operatorStack == NULL) {
+        ParsingError(parser, "empty operator stack");
     }
 
-    char result = operatorStack->operator;
+    char result = parser->operatorStack->operator;
 
-    CharList *stackTop = operatorStack;
-    operatorStack = stackTop->next;
+    CharList *stackTop = parser->operatorStack;
+    parser->operatorStack = stackTop->next;
     free(stackTop);
 
     return result;
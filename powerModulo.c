@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "header.h"
+
+// Montgomery representation of numbers modulo an odd modulus m of n digits :
+// x is represented by x*R mod m, with R = 2^(32*n).
+// Montgomery product of x*R and y*R gives x*y*R mod m without any division.
+typedef struct Montgomery {
+    IntExt modulus;     // odd modulus, positive
+    uint32_t inverse;   // -m^(-1) mod 2^32
+    uint32_t *buffer;   // n + 2 digits used by MontgomeryMultiply
+} Montgomery;
+
+static void PowerModuloMontgomery(IntExt *base, IntExt power, IntExt modulus);
+static void PowerModuloClassic(IntExt *base, IntExt power, IntExt modulus);
+static uint32_t MontgomeryInverse(uint32_t digit);
+static void MontgomeryMultiply(Montgomery *montgomery, uint32_t *result, uint32_t *a, uint32_t *b);
+static IntExt ToMontgomery(IntExt value, IntExt modulus);
+
+
+// Calculate (base)^(power) % (modulus), without computing (base)^(power)
+// Result has the sign of (base)^(power), like Modulo. Power can be of any size.
+// Result is stored in base. Returns error code if power is negative or modulus is zero
+int BcPowerModulo(IntExt *base, IntExt power, IntExt modulus) {
+    if (power.negative) {
+        return BIGCALC_ERROR_NEGATIVE_EXPONENT;
+    }
+
+    if (BcIsZero(modulus)) {
+        return BIGCALC_ERROR_DIVISION_BY_ZERO;
+    }
+
+    uint64_t profileStart = BcProfileStart();
+    int operandLength = modulus.length;
+
+    int negative = base->negative && BcGetBit(power, 0);
+    base->negative = 0;
+    modulus.negative = 0;
+
+    // memory stays bounded by modulus size : reduce base first
+    BcModulo(base, modulus);
+
+    if (GetDigits(&modulus)[0] % 2) {
+        PowerModuloMontgomery(base, power, modulus);
+    } else {
+        // Montgomery reduction requires an odd modulus
+        PowerModuloClassic(base, power, modulus);
+    }
+
+    base->negative = negative;
+    BcRemoveHeadZeros(base);
+
+    BcProfileStop(PROFILE_POWER_MODULO, profileStart, operandLength);
+
+    return BIGCALC_OK;
+}
+
+// Binary exponentiation with Montgomery products, for odd modulus
+// Base should be positive and lower than modulus
+static void PowerModuloMontgomery(IntExt *base, IntExt power, IntExt modulus) {
+    int n = modulus.length;
+
+    Montgomery montgomery;
+    montgomery.modulus = modulus;
+    montgomery.inverse = MontgomeryInverse(GetDigits(&modulus)[0]);
+    montgomery.buffer = BcAllocateDigits(n + 2);
+
+    // factor = base*R mod m, result = 1*R mod m
+    IntExt factor = ToMontgomery(*base, modulus);
+    IntExt one = BcInitiateIntExt(1, 0);
+    IntExt result = ToMontgomery(one, modulus);
+    BcFreeIntExt(one);
+
+    uint32_t *resultDigits = GetDigits(&result);
+    uint32_t *factorDigits = GetDigits(&factor);
+
+    // scan power bits from most significant to least significant
+    for (int64_t i = BcGetBitLength(power) - 1; i >= 0; i--) {
+        MontgomeryMultiply(&montgomery, resultDigits, resultDigits, resultDigits);
+        if (BcGetBit(power, i)) {
+            MontgomeryMultiply(&montgomery, resultDigits, resultDigits, factorDigits);
+        }
+    }
+
+    // leave Montgomery representation : multiply by 1
+    for (int i = 0; i < n; i++) {
+        factorDigits[i] = 0;
+    }
+    factorDigits[0] = 1;
+    MontgomeryMultiply(&montgomery, resultDigits, resultDigits, factorDigits);
+
+    BcFreeIntExt(factor);
+    BcFreeDigits(montgomery.buffer);
+
+    BcReplaceDigits(base, result);
+    BcRemoveHeadZeros(base);
+}
+
+// Binary exponentiation reducing modulo (modulus) after each multiplication
+// Base should be positive and lower than modulus
+static void PowerModuloClassic(IntExt *base, IntExt power, IntExt modulus) {
+    IntExt result = BcInitiateIntExt(1, 0);
+    BcModulo(&result, modulus);
+
+    for (int64_t i = BcGetBitLength(power) - 1; i >= 0; i--) {
+        BcMultiply(&result, result);
+        BcModulo(&result, modulus);
+        if (BcGetBit(power, i)) {
+            BcMultiply(&result, *base);
+            BcModulo(&result, modulus);
+        }
+    }
+
+    BcReplaceDigits(base, result);
+}
+
+// Return -digit^(-1) mod 2^32, digit should be odd
+static uint32_t MontgomeryInverse(uint32_t digit) {
+    // Newton iteration : each step doubles the number of correct bits
+    // digit is its own inverse modulo 2^3
+    uint32_t inverse = digit;
+    for (int i = 0; i < 4; i++) {
+        inverse *= 2 - digit * inverse;
+    }
+
+    return -inverse;
+}
+
+// Calculate result = a*b/R mod m, a and b being lower than m
+// a, b and result are digit arrays of modulus length, result can be the same array as a or b
+static void MontgomeryMultiply(Montgomery *montgomery, uint32_t *result, uint32_t *a, uint32_t *b) {
+// coarsely integrated operand scanning : for each digit of b, add a*digit to t,
+// then add a multiple of m cancelling t least significant digit, and shift t by one digit
+// t stays lower than 2*m, so that a single final substraction is enough
+    int n = montgomery->modulus.length;
+    uint32_t *m = GetDigits(&montgomery->modulus);
+    uint32_t *t = montgomery->buffer;
+
+    for (int i = 0; i < n + 2; i++) {
+        t[i] = 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        // t = t + a*b[i]
+        uint64_t carry = 0, digit = (uint64_t) b[i];
+        for (int j = 0; j < n; j++) {
+            uint64_t sum = (uint64_t) t[j] + (uint64_t) a[j] * digit + carry;
+            t[j] = (uint32_t) sum;
+            carry = sum >> 32;
+        }
+        uint64_t sum = (uint64_t) t[n] + carry;
+        t[n] = (uint32_t) sum;
+        t[n + 1] = (uint32_t) (sum >> 32);
+
+        // t = (t + m*q) / 2^32, with q chosen so that t + m*q is a multiple of 2^32
+        uint64_t q = (uint64_t) (t[0] * montgomery->inverse);
+        sum = (uint64_t) t[0] + (uint64_t) m[0] * q;
+        carry = sum >> 32;
+        for (int j = 1; j < n; j++) {
+            sum = (uint64_t) t[j] + (uint64_t) m[j] * q + carry;
+            t[j - 1] = (uint32_t) sum;
+            carry = sum >> 32;
+        }
+        sum = (uint64_t) t[n] + carry;
+        t[n - 1] = (uint32_t) sum;
+        t[n] = t[n + 1] + (uint32_t) (sum >> 32);
+    }
+
+    // substract m if t >= m
+    int greaterOrEqual = t[n] != 0;
+    if (!greaterOrEqual) {
+        greaterOrEqual = 1;
+        for (int i = n - 1; i >= 0; i--) {
+            if (t[i] != m[i]) {
+                greaterOrEqual = t[i] > m[i];
+                break;
+            }
+        }
+    }
+
+    if (greaterOrEqual) {
+        uint32_t carry = 0;
+        for (int i = 0; i < n; i++) {
+            uint32_t mDigit = m[i];
+            uint32_t nextCarry = t[i] < mDigit || (t[i] == mDigit && carry);
+            t[i] -= mDigit + carry;
+            carry = nextCarry;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        result[i] = t[i];
+    }
+}
+
+// Return value*R mod m, as an array of exactly (modulus.length) digits
+static IntExt ToMontgomery(IntExt value, IntExt modulus) {
+    int n = modulus.length;
+
+    // shift value by n digits
+    IntExt result = BcInitiateIntExtZero(value.length + n);
+    uint32_t *resultDigits = GetDigits(&result), *valueDigits = GetDigits(&value);
+    for (int i = 0; i < value.length; i++) {
+        resultDigits[n + i] = valueDigits[i];
+    }
+    BcRemoveHeadZeros(&result);
+
+    BcModulo(&result, modulus);
+
+    // pad with zeros up to modulus length
+    IntExt padded = BcInitiateIntExtZero(n);
+    uint32_t *paddedDigits = GetDigits(&padded);
+    resultDigits = GetDigits(&result);
+    for (int i = 0; i < result.length; i++) {
+        paddedDigits[i] = resultDigits[i];
+    }
+    BcFreeIntExt(result);
+
+    return padded;
+}
+
@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "header.h"
+
+// Table of powers of ten used by decimal conversions : entry of rank k is 10^(18 * 2^k)
+// Each entry is the square of the previous one.
+// Entries can be stored in a cache directory and memory mapped on later runs.
+
+#define POWER_TABLE_SIZE 40     // entry of rank 32 has more digits than an IntExt can hold
+#define CACHE_MAGIC "BIGCPOW1"
+#define CACHE_BYTE_ORDER 0x01020304u    // detects files written on a machine with other endianness
+
+// Header of cache files, followed by entry digits
+typedef struct CacheHeader {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t digitBits;     // size of digits, in bits
+    uint64_t exponent;      // file contains 10^exponent
+    uint64_t length;        // number of digits
+    uint64_t checksum;      // FNV-1a hash of digits
+} CacheHeader;
+
+static IntExt powerTable[POWER_TABLE_SIZE];
+static int powerTableLength = 0;           // number of entries computed or loaded
+static pthread_mutex_t powerTableLock = PTHREAD_MUTEX_INITIALIZER;     // table is shared by all library contexts
+
+// mapping of entries loaded from cache, NULL for computed entries
+static void *powerTableMappings[POWER_TABLE_SIZE];
+static size_t powerTableMappingSizes[POWER_TABLE_SIZE];
+
+static char *cacheDirectory = NULL;
+
+static void ComputePowerTableEntry(int rank);
+static int LoadPowerTableEntry(int rank);
+static void SavePowerTableEntry(int rank);
+static char *GetCacheFileName(int rank);
+static uint64_t ComputeChecksum(uint32_t *digits, uint64_t length);
+
+
+// Store power table entries in given directory, and reuse entries found there
+void BcSetPowerTableCache(char *directory) {
+    cacheDirectory = directory;
+}
+
+// Return 10^(18 * 2^rank), computing or loading table entries if needed
+// Returned value belongs to the table : it must not be modified or freed
+// Entries are never modified once set, so they can be read by several threads
+IntExt BcGetPowerOfTen(int rank) {
+    pthread_mutex_lock(&powerTableLock);
+
+    while (powerTableLength <= rank) {
+        uint64_t profileStart = BcProfileStart();
+
+        ComputePowerTableEntry(powerTableLength);
+        powerTableLength++;
+
+        BcProfileStop(PROFILE_POWER_TABLE, profileStart, powerTable[powerTableLength - 1].length);
+    }
+
+    IntExt result = powerTable[rank];
+
+    pthread_mutex_unlock(&powerTableLock);
+
+    return result;
+}
+
+// Free all table entries
+// No other thread should be using the table
+void BcFreePowerTable() {
+    pthread_mutex_lock(&powerTableLock);
+
+    for (int i = 0; i < powerTableLength; i++) {
+        if (powerTableMappings[i] != NULL) {
+            munmap(powerTableMappings[i], powerTableMappingSizes[i]);
+        } else {
+            BcFreeIntExt(powerTable[i]);
+        }
+    }
+
+    powerTableLength = 0;
+
+    pthread_mutex_unlock(&powerTableLock);
+}
+
+// Set table entry of given rank, previous entries being already set
+static void ComputePowerTableEntry(int rank) {
+    powerTableMappings[rank] = NULL;
+
+    if (LoadPowerTableEntry(rank)) {
+        return;
+    }
+
+    IntExt entry;
+    if (rank == 0) {
+        entry = BcInitiateIntExt(0, 0);
+        BcSetSmallValue(&entry, 1000000000000000000ull);
+    } else {
+        entry = BcDuplicateIntExt(powerTable[rank - 1]);
+        BcMultiply(&entry, powerTable[rank - 1]);
+    }
+    powerTable[rank] = entry;
+
+    SavePowerTableEntry(rank);
+}
+
+// Set table entry of given rank from cache file
+// Returns 0 if there is no cache, or if cache file is missing, truncated or invalid
+static int LoadPowerTableEntry(int rank) {
+    if (cacheDirectory == NULL) {
+        return 0;
+    }
+
+    char *fileName = GetCacheFileName(rank);
+    int file = open(fileName, O_RDONLY);
+    free(fileName);
+    if (file < 0) {
+        return 0;
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || (size_t) fileStat.st_size <= sizeof(CacheHeader)) {
+        close(file);
+        return 0;
+    }
+
+    size_t size = (size_t) fileStat.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED) {
+        return 0;
+    }
+
+    CacheHeader *header = mapping;
+    uint32_t *digits = (uint32_t *) ((char *) mapping + sizeof(CacheHeader));
+
+    int valid = memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) == 0
+            && header->byteOrder == CACHE_BYTE_ORDER
+            && header->digitBits == 32
+            && header->exponent == (uint64_t) 18 << rank
+            && header->length > 0
+            && header->length <= INT32_MAX
+            && size == sizeof(CacheHeader) + header->length * sizeof(uint32_t)
+            && digits[header->length - 1] != 0
+            && header->checksum == ComputeChecksum(digits, header->length);
+
+    if (!valid) {
+        munmap(mapping, size);
+        return 0;
+    }
+
+    powerTable[rank].allocatedDigits = digits;
+    powerTable[rank].length = (int) header->length;
+    powerTable[rank].negative = 0;
+    powerTableMappings[rank] = mapping;
+    powerTableMappingSizes[rank] = size;
+
+    return 1;
+}
+
+// Write table entry of given rank to cache directory
+// File is written under a temporary name then renamed, so that readers never see a partial file
+static void SavePowerTableEntry(int rank) {
+    if (cacheDirectory == NULL) {
+        return;
+    }
+
+    IntExt entry = powerTable[rank];
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.byteOrder = CACHE_BYTE_ORDER;
+    header.digitBits = 32;
+    header.exponent = (uint64_t) 18 << rank;
+    header.length = (uint64_t) entry.length;
+    header.checksum = ComputeChecksum(GetDigits(&entry), header.length);
+
+    char *fileName = GetCacheFileName(rank);
+    char *temporaryName = malloc(strlen(fileName) + 32);
+    sprintf(temporaryName, "%s.%ld.tmp", fileName, (long) getpid());
+
+    FILE *file = fopen(temporaryName, "wb");
+    if (file != NULL) {
+        int written = fwrite(&header, sizeof(header), 1, file) == 1
+                && fwrite(GetDigits(&entry), sizeof(uint32_t), entry.length, file) == (size_t) entry.length;
+        if (fclose(file) == 0 && written) {
+            rename(temporaryName, fileName);
+        } else {
+            remove(temporaryName);
+        }
+    }
+
+    free(temporaryName);
+    free(fileName);
+}
+
+// Return path of cache file for entry of given rank, keyed by digit size and exponent
+static char *GetCacheFileName(int rank) {
+    char *result = malloc(strlen(cacheDirectory) + 64);
+    sprintf(result, "%s/pow10_d32_e%llu.bin", cacheDirectory, (unsigned long long) 18 << rank);
+
+    return result;
+}
+
+// Return FNV-1a hash of digits
+static uint64_t ComputeChecksum(uint32_t *digits, uint64_t length) {
+    uint64_t result = 14695981039346656037ULL;
+
+    for (uint64_t i = 0; i < length; i++) {
+        uint32_t digit = digits[i];
+        for (int j = 0; j < 4; j++) {
+            result ^= (digit >> (8 * j)) & 0xFF;
+            result *= 1099511628211ULL;
+        }
+    }
+
+    return result;
+}
@@ -1,29 +1,40 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
-#include <time.h>
+#include <pthread.h>
 #include "header.h"
 
-const uint64_t STRING_BASE = 1000000000000000000;   // maximum power of ten usable with uint64_t format
-const int STRING_BASE_LENGTH = 18;
+// Printing of results by calculate program, with optional details and streaming
 
-// Chained list to store decimal values while converting IntExt to decimal
-// Head is least significant
-typedef struct DecimalString {
-    uint64_t value;                 // will be between 0 and STRING_BASE - 1
-    struct DecimalString *next;
-} DecimalString;
+#define STREAM_BUFFER_SIZE (1 << 18)    // characters handed to the writer thread at once
+#define STREAM_BUFFER_COUNT 4           // bounds characters waiting to be written
 
+// Decimal characters waiting to be written to standard output by the writer thread
+// Buffers form a ring : (queued) buffers from (head) are written in order, buffer (filled) is being filled
+typedef struct DecimalStream {
+    char *buffers[STREAM_BUFFER_COUNT];
+    int lengths[STREAM_BUFFER_COUNT];
+    int head;
+    int queued;
+    int filled;
+    int finished;               // 1 when last buffer is queued
+    int64_t length;             // characters written
+    int synchronous;            // 1 if writer thread could not be started : buffers are written when they are full
 
-DecimalString *CreateDecimalString(uint64_t value);
-void FreeDecimalString(DecimalString *string);
+    pthread_mutex_t lock;       // protects head, queued and finished
+    pthread_cond_t changed;
+    pthread_t writer;
+} DecimalStream;
 
-void PrintDecimal(IntExt intExt, int decimalDetails);
-DecimalString *ComputeDecimalString(IntExt intExt);
-int PrintDecimalString(DecimalString *string);
+static void PrintBinaryDetails(IntExt intExt);
+static void PrintDecimal(IntExt intExt, int decimalDetails);
+static int PrintDecimalString(DecimalString *string);
 
-void Add_DecimalString(DecimalString *base, DecimalString *term, uint64_t carry);
-void MultBy2_DecimalString(DecimalString *DecimalString, uint64_t carry);
+static void StreamDecimalPart(DecimalStream *stream, IntExt value, int rank, int padded);
+static void StreamDecimalLeaf(DecimalStream *stream, DecimalString *string, int padded);
+static void StreamDecimalElement(DecimalStream *stream, uint64_t value, int padded);
+static void QueueStreamBuffer(DecimalStream *stream);
+static void *RunStreamWriter(void *argument);
 
 
 // Print intExt decimal notation
@@ -31,44 +42,92 @@ void MultBy2_DecimalString(DecimalString *DecimalString, uint64_t carry);
 // decimalDetails = true : also prints decimal length
 void PrintIntExt(IntExt intExt, int binaryDetails, int decimalDetails) {
     if (binaryDetails) {
-        printf("--Binary--\nLength : %d\n", intExt.length);
-        if (intExt.negative) {
-            printf("Negative\n");
-        } else {
-            printf("Positive\n");
-        }
-        printf("Digits :\n");
-        for (int i = 0; i < intExt.length; i++) {
-            printf("%lu  ", (unsigned long) intExt.digits[i]);
-        }
-        printf("\n");
+        PrintBinaryDetails(intExt);
     }
 
     PrintDecimal(intExt, decimalDetails);
 }
 
-// Return DecimalString with given value
-DecimalString *CreateDecimalString(uint64_t value) {
-    DecimalString *result = malloc(sizeof(DecimalString));
-    result->value = value;
-    result->next = NULL;
-    return result;
-}
+// Print intExt decimal notation like PrintIntExt, most significant characters being written while next ones are computed
+// intExt is freed as it is converted : memory holds parts of intExt not printed yet, and a few buffers of characters
+void StreamIntExt(IntExt intExt, int binaryDetails, int decimalDetails) {
+    if (binaryDetails) {
+        PrintBinaryDetails(intExt);
+    }
+
+    uint64_t profileStart = BcProfileStart();
+    int length = intExt.length;
+
+    if (decimalDetails) {
+        printf("--Decimal--\n");
+    }
+    if (intExt.negative) {
+        printf("-");
+    }
+    // the writer thread is the only one using standard output until conversion ends
+    fflush(stdout);
+
+    DecimalStream stream;
+    for (int i = 0; i < STREAM_BUFFER_COUNT; i++) {
+        stream.buffers[i] = BcProfileMalloc(STREAM_BUFFER_SIZE);
+        stream.lengths[i] = 0;
+    }
+    stream.head = 0;
+    stream.queued = 0;
+    stream.filled = 0;
+    stream.finished = 0;
+    stream.length = 0;
+    pthread_mutex_init(&stream.lock, NULL);
+    pthread_cond_init(&stream.changed, NULL);
+    stream.synchronous = pthread_create(&stream.writer, NULL, RunStreamWriter, &stream) != 0;
+
+    intExt.negative = 0;
+    StreamDecimalPart(&stream, intExt, BcGetDecimalRank(intExt), 0);
+
+    if (stream.synchronous) {
+        QueueStreamBuffer(&stream);
+    } else {
+        pthread_mutex_lock(&stream.lock);
+        stream.queued++;
+        stream.finished = 1;
+        pthread_cond_signal(&stream.changed);
+        pthread_mutex_unlock(&stream.lock);
+        pthread_join(stream.writer, NULL);
+    }
 
-// Recursively free all elements in string
-void FreeDecimalString(DecimalString *string) {
-    DecimalString *next = string->next;
+    for (int i = 0; i < STREAM_BUFFER_COUNT; i++) {
+        BcProfileFree(stream.buffers[i]);
+    }
+    pthread_mutex_destroy(&stream.lock);
+    pthread_cond_destroy(&stream.changed);
+
+    printf("\n");
+    if (decimalDetails) {
+        printf("Length\n%lld\n", (long long) stream.length);
+    }
+
+    BcProfileStop(PROFILE_DECIMAL_STRING, profileStart, length);
+}
 
-    free(string);
-    if (next != NULL) {
-        FreeDecimalString(next);
+// Print number of intExt digits and their values
+static void PrintBinaryDetails(IntExt intExt) {
+    printf("--Binary--\nLength : %d\n", intExt.length);
+    if (intExt.negative) {
+        printf("Negative\n");
+    } else {
+        printf("Positive\n");
     }
+    printf("Digits :\n");
+    for (int i = 0; i < intExt.length; i++) {
+        printf("%lu  ", (unsigned long) GetDigits(&intExt)[i]);
+    }
+    printf("\n");
 }
 
 // Print decimal notation of intExt
 // DecimalDetails = true : also prints decimal length
-void PrintDecimal(IntExt intExt, int decimalDetails) {
-    DecimalString *decimalDecimalString = ComputeDecimalString(intExt);
+static void PrintDecimal(IntExt intExt, int decimalDetails) {
+    DecimalString *decimalDecimalString = BcComputeDecimalString(intExt);
 
     if (decimalDetails) {
         printf("--Decimal--\n");
@@ -84,34 +143,12 @@ void PrintDecimal(IntExt intExt, int decimalDetails) {
         printf("Length\n%d\n", decimalLength);
     }
 
-    FreeDecimalString(decimalDecimalString);
-}
-
-
-// compute and return DecimalString from intExt by performing bit to bit decomposition.
-DecimalString *ComputeDecimalString(IntExt intExt) {
-    DecimalString *result = CreateDecimalString(0);   // decimal representation of intExt
-    DecimalString *powers = CreateDecimalString(1);   // stores successive powers of 2
-
-    for (int i = 0; i < intExt.length; i++) {
-        uint32_t digit = intExt.digits[i];
-        for (int j = 0; j < 32; j++) {
-            if (digit % 2) {
-                Add_DecimalString(result, powers, 0);
-            }
-            digit = digit >> 1;
-            MultBy2_DecimalString(powers, 0);
-        }
-    }
-
-    FreeDecimalString(powers);
-
-    return result;
+    BcFreeDecimalString(decimalDecimalString);
 }
 
 // Recursively print all values in DecimalString.
 // Returns number of characters printed
-int PrintDecimalString(DecimalString *string) {
+static int PrintDecimalString(DecimalString *string) {
     int result;
 
     if (string->next != NULL) {
@@ -119,12 +156,13 @@ int PrintDecimalString(DecimalString *string) {
 
         printf("%018llu", (unsigned long long) string->value);
     } else {
+        // zero is printed as a single character
         result = 0;
         uint64_t digit = string->value;
-        while (digit > 0) {
+        do {
             result ++;
             digit = digit / 10;
-        }
+        } while (digit > 0);
 
         printf("%llu", (unsigned long long) string->value);
     }
@@ -132,43 +170,115 @@ int PrintDecimalString(DecimalString *string) {
     return result;
 }
 
-// Recursively multiply each element in DecimalString by 2, pass carry to next element if needed
-void MultBy2_DecimalString(DecimalString *string, uint64_t carry) {
-    uint64_t value = string->value * 2 + carry;
-    string->value = value % STRING_BASE;
+// Write decimal representation of value, lower than 10^(18 * 2^(rank + 1)), to stream
+// Same splitting as AppendDecimalString, most significant part being converted and written first
+// value is freed
+static void StreamDecimalPart(DecimalStream *stream, IntExt value, int rank, int padded) {
+    if (rank < LEAF_RANK) {
+        DecimalString *string = NULL;
+        DecimalString **tail = &string;
+        BcAppendDecimalStringLeaf(value, padded ? 2 << rank : 0, &tail);
+        StreamDecimalLeaf(stream, string, padded);
+        BcFreeDecimalString(string);
+        return;
+    }
+
+    IntExt power = BcGetPowerOfTen(rank);
+
+    if (!padded && BcCompareAbsoluteValue(value, power) < 0) {
+        // high part would be zero
+        StreamDecimalPart(stream, value, rank - 1, 0);
+        return;
+    }
+
+    IntExt low;
+    BcEuclideanDivision(&value, power, &low);
+
+    StreamDecimalPart(stream, value, rank - 1, padded);
+    StreamDecimalPart(stream, low, rank - 1, 1);
+}
+
+// Recursively write all values in DecimalString to stream, most significant first
+static void StreamDecimalLeaf(DecimalStream *stream, DecimalString *string, int padded) {
     if (string->next != NULL) {
-        MultBy2_DecimalString(string->next, value / STRING_BASE);
-    } else if (value >= STRING_BASE) {
-        // add last element with carry as value
-        DecimalString *next = malloc(sizeof(DecimalString));
-        next->value = value / STRING_BASE;
-        next->next = NULL;
-        string->next = next;
+        StreamDecimalLeaf(stream, string->next, padded);
+        StreamDecimalElement(stream, string->value, 1);
+    } else {
+        StreamDecimalElement(stream, string->value, padded);
     }
 }
 
-// Recursively add DecimalString, pass carry to next element if needed
-// Result is stored in base DecimalString
-void Add_DecimalString(DecimalString *base, DecimalString *term, uint64_t carry) {
-    uint64_t value = base->value + term->value + carry;
-    base->value = value % STRING_BASE;
+// Write decimal characters of value to stream
+// padded = 1 : write exactly STRING_BASE_LENGTH characters
+static void StreamDecimalElement(DecimalStream *stream, uint64_t value, int padded) {
+    if (stream->lengths[stream->filled] > STREAM_BUFFER_SIZE - STRING_BASE_LENGTH) {
+        QueueStreamBuffer(stream);
+    }
 
-    if (base->next == NULL && term->next == NULL) {
-        // add last element with carry as value
-        if (value >= STRING_BASE) {
-            base->next = CreateDecimalString(value / STRING_BASE);
+    int count = STRING_BASE_LENGTH;
+    if (!padded) {
+        count = 1;
+        for (uint64_t rest = value / 10; rest > 0; rest /= 10) {
+            count++;
         }
+    }
+
+    char *end = stream->buffers[stream->filled] + stream->lengths[stream->filled] + count;
+    BcWriteDecimalElement(end, value, padded);
+    stream->lengths[stream->filled] += count;
+    stream->length += count;
+}
+
+// Hand buffer being filled to the writer thread, and wait for a free buffer to fill
+// Without writer thread, buffer is written and filled again
+static void QueueStreamBuffer(DecimalStream *stream) {
+    if (stream->synchronous) {
+        fwrite(stream->buffers[stream->filled], 1, stream->lengths[stream->filled], stdout);
+        stream->lengths[stream->filled] = 0;
         return;
     }
-    
-    // extend shorter number with 0 if needed
-    if (base->next == NULL) {
-        base->next = CreateDecimalString(0);
+
+    pthread_mutex_lock(&stream->lock);
+
+    stream->queued++;
+    pthread_cond_signal(&stream->changed);
+    while (stream->queued == STREAM_BUFFER_COUNT) {
+        pthread_cond_wait(&stream->changed, &stream->lock);
     }
-    
-    if (term->next == NULL) {
-        term->next = CreateDecimalString(0);
+    stream->filled = (stream->head + stream->queued) % STREAM_BUFFER_COUNT;
+
+    pthread_mutex_unlock(&stream->lock);
+
+    stream->lengths[stream->filled] = 0;
+}
+
+// Write queued buffers to standard output until last one is written
+static void *RunStreamWriter(void *argument) {
+    DecimalStream *stream = argument;
+
+    pthread_mutex_lock(&stream->lock);
+
+    while (1) {
+        while (stream->queued == 0 && !stream->finished) {
+            pthread_cond_wait(&stream->changed, &stream->lock);
+        }
+        if (stream->queued == 0) {
+            break;
+        }
+
+        // buffer is not modified while it is queued : it is written without lock
+        int index = stream->head;
+        pthread_mutex_unlock(&stream->lock);
+        fwrite(stream->buffers[index], 1, stream->lengths[index], stdout);
+        fflush(stdout);
+        pthread_mutex_lock(&stream->lock);
+
+        stream->head = (stream->head + 1) % STREAM_BUFFER_COUNT;
+        stream->queued--;
+        pthread_cond_signal(&stream->changed);
     }
 
-    Add_DecimalString(base->next, term->next, value / STRING_BASE);
+    pthread_mutex_unlock(&stream->lock);
+
+    return NULL;
 }
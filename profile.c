@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "header.h"
+
+#define PROFILE_HEADER_SIZE 16      // bytes reserved before each profiled allocation, keeps alignment
+
+static int profilingEnabled = 0;
+static pthread_mutex_t profileLock = PTHREAD_MUTEX_INITIALIZER;    // counters are updated by all evaluation threads
+
+static Profile profile;    // allocation counters are only updated while profiling
+
+static uint64_t GetMonotonicTime();
+static int GetHistogramBucket(int length);
+
+
+// Enable profiling. Must be called before any profiled allocation.
+void BcEnableProfiling() {
+    profilingEnabled = 1;
+}
+
+// Return start time of a profiled phase, or 0 if profiling is disabled
+uint64_t BcProfileStart() {
+    if (!profilingEnabled) {
+        return 0;
+    }
+
+    return GetMonotonicTime();
+}
+
+// Record a call of given phase, started at (start), with an operand of given length
+// note : phases may be nested (exponent calls multiply), their times are inclusive
+void BcProfileStop(int phase, uint64_t start, int operandLength) {
+    if (!profilingEnabled) {
+        return;
+    }
+
+    uint64_t stop = GetMonotonicTime();
+
+    pthread_mutex_lock(&profileLock);
+    PhaseCounters *counters = &profile.phases[phase];
+    counters->calls++;
+    counters->nanoseconds += stop - start;
+    counters->histogram[GetHistogramBucket(operandLength)]++;
+    pthread_mutex_unlock(&profileLock);
+}
+
+// Allocate (size) bytes, counting them if profiling is enabled
+// Size is stored in front of the returned block so that BcProfileFree can update counters
+void *BcProfileMalloc(size_t size) {
+    if (!profilingEnabled) {
+        return malloc(size);
+    }
+
+    char *block = malloc(size + PROFILE_HEADER_SIZE);
+    if (block == NULL) {
+        return NULL;
+    }
+    *((size_t *) block) = size;
+
+    pthread_mutex_lock(&profileLock);
+    profile.allocationCount++;
+    profile.allocatedBytes += size;
+    profile.currentBytes += size;
+    if (profile.currentBytes > profile.peakBytes) {
+        profile.peakBytes = profile.currentBytes;
+    }
+    pthread_mutex_unlock(&profileLock);
+
+    return block + PROFILE_HEADER_SIZE;
+}
+
+// Resize block allocated with BcProfileMalloc to (size) bytes, keeping its content
+void *BcProfileRealloc(void *ptr, size_t size) {
+    if (!profilingEnabled) {
+        return realloc(ptr, size);
+    }
+
+    char *block = realloc((char *) ptr - PROFILE_HEADER_SIZE, size + PROFILE_HEADER_SIZE);
+    if (block == NULL) {
+        return NULL;
+    }
+    size_t previousSize = *((size_t *) block);
+    *((size_t *) block) = size;
+
+    pthread_mutex_lock(&profileLock);
+    if (size > previousSize) {
+        profile.allocatedBytes += size - previousSize;
+    }
+    profile.currentBytes += size - previousSize;
+    if (profile.currentBytes > profile.peakBytes) {
+        profile.peakBytes = profile.currentBytes;
+    }
+    pthread_mutex_unlock(&profileLock);
+
+    return block + PROFILE_HEADER_SIZE;
+}
+
+// Free block allocated with BcProfileMalloc
+void BcProfileFree(void *ptr) {
+    if (!profilingEnabled || ptr == NULL) {
+        free(ptr);
+        return;
+    }
+
+    char *block = (char *) ptr - PROFILE_HEADER_SIZE;
+    pthread_mutex_lock(&profileLock);
+    profile.currentBytes -= *((size_t *) block);
+    pthread_mutex_unlock(&profileLock);
+    free(block);
+}
+
+// Count (size) bytes of digits stored in mapped files, negative when they are unmapped
+void BcProfileMapping(int64_t size) {
+    if (!profilingEnabled) {
+        return;
+    }
+
+    pthread_mutex_lock(&profileLock);
+    profile.currentMappedBytes += size;
+    if (profile.currentMappedBytes > profile.peakMappedBytes) {
+        profile.peakMappedBytes = profile.currentMappedBytes;
+    }
+    pthread_mutex_unlock(&profileLock);
+}
+
+// Copy current profiling counters into (result)
+void BcGetProfile(Profile *result) {
+    pthread_mutex_lock(&profileLock);
+    *result = profile;
+    pthread_mutex_unlock(&profileLock);
+}
+
+// Return monotonic clock time in nanoseconds
+static uint64_t GetMonotonicTime() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000000ULL + (uint64_t) time.tv_nsec;
+}
+
+// Return histogram bucket of given operand length : floor(log2(length))
+static int GetHistogramBucket(int length) {
+    int bucket = 0;
+
+    while (length > 1 && bucket < PROFILE_HISTOGRAM_SIZE - 1) {
+        length = length >> 1;
+        bucket++;
+    }
+
+    return bucket;
+}
@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "header.h"
+
+#define BLOCK_LENGTH 9              // decimal digits converted at once, 10^9 fits in a single digit
+#define DIRECT_READ_LENGTH 288      // numbers up to (18 * 2^4) decimal digits are read without power table
+
+static IntExt ReadDecimalDirect(char *decimal, int length);
+
+
+// Convert (length) decimal characters into a positive IntExt
+// Long numbers are split into a high and a low part, low part having 18 * 2^k characters :
+// number = high * 10^(18 * 2^k) + low, using power table entry of rank k
+IntExt BcReadDecimal(char *decimal, int length) {
+    if (length <= DIRECT_READ_LENGTH) {
+        return ReadDecimalDirect(decimal, length);
+    }
+
+    // low part is the biggest 18 * 2^k lower than length, so that high part is not longer than low part
+    int rank = 0;
+    while ((18 << (rank + 1)) < length) {
+        rank++;
+    }
+    int lowLength = 18 << rank;
+
+    IntExt result = BcReadDecimal(decimal, length - lowLength);
+    IntExt low = BcReadDecimal(decimal + length - lowLength, lowLength);
+
+    BcMultiply(&result, BcGetPowerOfTen(rank));
+    BcAdd(&result, low);
+    BcFreeIntExt(low);
+
+    return result;
+}
+
+// Convert (length) decimal characters into a positive IntExt, by blocks of BLOCK_LENGTH characters
+// each block is added with a single pass : result = result * 10^BLOCK_LENGTH + block
+static IntExt ReadDecimalDirect(char *decimal, int length) {
+    // each block adds less than 30 bits
+    IntExt result = BcInitiateIntExtZero(length / BLOCK_LENGTH + 2);
+    uint32_t *digits = GetDigits(&result);
+    result.length = 1;
+
+    // first block takes remaining characters, so that next ones are complete
+    int blockLength = length % BLOCK_LENGTH == 0 ? BLOCK_LENGTH : length % BLOCK_LENGTH;
+    int position = 0;
+
+    while (position < length) {
+        uint64_t block = 0, multiplier = 1;
+        for (int i = 0; i < blockLength; i++) {
+            block = block * 10 + (uint64_t) (decimal[position + i] - '0');
+            multiplier *= 10;
+        }
+
+        uint64_t carry = block;
+        for (int i = 0; i < result.length; i++) {
+            uint64_t digit = (uint64_t) digits[i] * multiplier + carry;
+            digits[i] = (uint32_t) digit;
+            carry = digit >> 32;
+        }
+        if (carry != 0) {
+            digits[result.length] = (uint32_t) carry;
+            result.length++;
+        }
+
+        position += blockLength;
+        blockLength = BLOCK_LENGTH;
+    }
+
+    BcRemoveHeadZeros(&result);
+
+    return result;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "header.h"
+
+// Reports printed by calculate program : profiling counters (-p) and estimation (--estimate)
+
+static const char *PHASE_NAMES[PROFILE_PHASE_COUNT] = {
+    "parse",
+    "evaluation",
+    "read number",
+    "multiply",
+    "divide",
+    "exponent",
+    "power modulo",
+    "decimal string",
+    "power table"
+};
+
+
+// Print profiling counters on stderr
+void PrintProfilingReport() {
+    Profile profile;
+    BcGetProfile(&profile);
+
+    fprintf(stderr, "--Profile--\n");
+    fprintf(stderr, "%-16s %12s %14s\n", "phase", "calls", "time (ms)");
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        fprintf(stderr, "%-16s %12llu %14.3f\n",
+                PHASE_NAMES[i],
+                (unsigned long long) profile.phases[i].calls,
+                profile.phases[i].nanoseconds / 1e6);
+    }
+
+    fprintf(stderr, "--Operand sizes (digits, tokens for parse)--\n");
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        if (profile.phases[i].calls == 0) {
+            continue;
+        }
+        fprintf(stderr, "%-16s", PHASE_NAMES[i]);
+        for (int k = 0; k < PROFILE_HISTOGRAM_SIZE; k++) {
+            if (profile.phases[i].histogram[k] != 0) {
+                fprintf(stderr, " [%llu-%llu]:%llu",
+                        1ULL << k,
+                        (2ULL << k) - 1,
+                        (unsigned long long) profile.phases[i].histogram[k]);
+            }
+        }
+        fprintf(stderr, "\n");
+    }
+
+    fprintf(stderr, "--Memory--\n");
+    fprintf(stderr, "Allocations : %llu\n", (unsigned long long) profile.allocationCount);
+    fprintf(stderr, "Allocated bytes : %llu\n", (unsigned long long) profile.allocatedBytes);
+    fprintf(stderr, "Peak bytes : %llu\n", (unsigned long long) profile.peakBytes);
+    fprintf(stderr, "Bytes still allocated : %llu\n", (unsigned long long) profile.currentBytes);
+    fprintf(stderr, "Peak mapped bytes : %llu\n", (unsigned long long) profile.peakMappedBytes);
+}
+
+// Print estimation report
+void PrintEstimate(Estimate estimate) {
+    printf("--Estimate--\n");
+
+    if (isinf(estimate.maxBits) || estimate.maxBits > 1e18) {
+        printf("Too large to be computed\n");
+        return;
+    }
+
+    printf("Result size : %.0f bits (%.0f decimal digits)\n",
+            floor(estimate.resultBits) + 1,
+            floor(estimate.resultBits / LOG2_10) + 1);
+    printf("Greatest value : %.0f bits\n", floor(estimate.maxBits) + 1);
+    printf("Peak memory : %.0f bytes\n", estimate.peakBytes);
+    printf("Operations : %.3g digit operations\n", estimate.operations);
+    if (estimate.outOfRange) {
+        printf("An exponent or a shift may be out of range (2^32 or more)\n");
+    }
+}
@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "header.h"
+
+// Digit arrays of at least MAPPED_STORAGE_THRESHOLD bytes can be stored in memory mapped temporary files
+// instead of heap memory, so that numbers greater than physical memory can be computed.
+// Files are unlinked as soon as they are created : they are removed by the system when unmapped.
+// Freed mappings are kept for reuse, so that temporary values do not each create, map and unmap a file.
+// Their contents are discarded by truncating the file, so that the system does not write dead pages to disk.
+
+#define MAPPED_STORAGE_THRESHOLD (1 << 20)
+#define MAPPED_STORAGE_GRANULARITY (1 << 20)    // mapping sizes are rounded up, leaving room for arrays to grow
+#define FREE_MAPPING_BYTES (1 << 30)            // freed mappings kept for reuse, besides the last freed one
+
+// Chained list of mapped digit arrays
+typedef struct Mapping {
+    uint32_t *digits;
+    size_t size;
+    int file;       // temporary file, kept open to discard contents when mapping is freed
+    struct Mapping *next;
+} Mapping;
+
+static char *storageDirectory = NULL;
+static Mapping *mappings = NULL;           // mappings in use
+static Mapping *freeMappings = NULL;       // mappings kept for reuse, most recently freed first
+static size_t freeMappingBytes = 0;
+static pthread_mutex_t mappingsLock = PTHREAD_MUTEX_INITIALIZER;   // lists are shared by all library contexts
+
+static uint32_t *MapDigits(size_t size);
+static uint32_t *ReuseMapping(size_t size);
+static Mapping *FindMapping(uint32_t *digits);
+static Mapping *RemoveMapping(uint32_t *digits);
+static void KeepMapping(Mapping *mapping);
+static void UnmapDigits(Mapping *mapping);
+
+
+// Store big digit arrays in memory mapped files created in given directory
+void BcSetStorageDirectory(char *directory) {
+    storageDirectory = directory;
+}
+
+// Return uninitialized digit array of given length
+uint32_t *BcAllocateDigits(int length) {
+    size_t size = sizeof(uint32_t) * (size_t) length;
+    uint32_t *result;
+
+    if (storageDirectory != NULL && size >= MAPPED_STORAGE_THRESHOLD) {
+        result = ReuseMapping(size);
+        if (result == NULL) {
+            result = MapDigits(size);
+        }
+    } else {
+        result = BcProfileMalloc(size);
+    }
+
+    // operations have no way to report it : abort without writing to the output of caller
+    if (result == NULL) {
+        abort();
+    }
+
+    return result;
+}
+
+// Return digit array of given length, keeping the values of its first (previousLength) digits
+// Mapped arrays are extended in place when their mapping is big enough, heap arrays are reallocated
+// unless they reach mapped storage size, in which case they are moved to a mapping
+uint32_t *BcResizeDigits(uint32_t *digits, int previousLength, int length) {
+    size_t size = sizeof(uint32_t) * (size_t) length;
+    uint32_t *result;
+
+    Mapping *mapping = storageDirectory != NULL ? FindMapping(digits) : NULL;
+    if (mapping != NULL && size <= mapping->size) {
+        return digits;
+    }
+
+    if (mapping != NULL || (storageDirectory != NULL && size >= MAPPED_STORAGE_THRESHOLD)) {
+        result = BcAllocateDigits(length);
+        memcpy(result, digits, sizeof(uint32_t) * (size_t) previousLength);
+        BcFreeDigits(digits);
+        return result;
+    }
+
+    result = BcProfileRealloc(digits, size);
+    // operations have no way to report it : abort without writing to the output of caller
+    if (result == NULL) {
+        abort();
+    }
+
+    return result;
+}
+
+// Free digit array returned by BcAllocateDigits
+// Mapped arrays are kept for reuse
+void BcFreeDigits(uint32_t *digits) {
+    // storage directory is set before any allocation : without it, there is no mapping to look for
+    if (storageDirectory != NULL) {
+        Mapping *mapping = RemoveMapping(digits);
+        if (mapping != NULL) {
+            KeepMapping(mapping);
+            return;
+        }
+    }
+
+    BcProfileFree(digits);
+}
+
+// Return a freed mapping of at least (size) bytes, NULL if there is none
+// Smallest one is chosen, and mappings more than twice bigger than size are left for bigger arrays
+static uint32_t *ReuseMapping(size_t size) {
+    pthread_mutex_lock(&mappingsLock);
+
+    Mapping **best = NULL;
+    for (Mapping **previous = &freeMappings; *previous != NULL; previous = &(*previous)->next) {
+        size_t mappingSize = (*previous)->size;
+        if (mappingSize >= size && mappingSize / 2 <= size && (best == NULL || mappingSize < (*best)->size)) {
+            best = previous;
+        }
+    }
+
+    uint32_t *result = NULL;
+    if (best != NULL) {
+        Mapping *mapping = *best;
+        *best = mapping->next;
+        freeMappingBytes -= mapping->size;
+        mapping->next = mappings;
+        mappings = mapping;
+        result = mapping->digits;
+    }
+
+    pthread_mutex_unlock(&mappingsLock);
+
+    return result;
+}
+
+// Return mapping in use holding given digits, NULL for heap arrays
+static Mapping *FindMapping(uint32_t *digits) {
+    pthread_mutex_lock(&mappingsLock);
+
+    Mapping *result = mappings;
+    while (result != NULL && result->digits != digits) {
+        result = result->next;
+    }
+
+    pthread_mutex_unlock(&mappingsLock);
+
+    return result;
+}
+
+// Remove mapping holding given digits from mappings in use and return it, NULL for heap arrays
+static Mapping *RemoveMapping(uint32_t *digits) {
+    pthread_mutex_lock(&mappingsLock);
+
+    Mapping **previous = &mappings;
+    while (*previous != NULL && (*previous)->digits != digits) {
+        previous = &(*previous)->next;
+    }
+
+    Mapping *result = *previous;
+    if (result != NULL) {
+        *previous = result->next;
+    }
+
+    pthread_mutex_unlock(&mappingsLock);
+
+    return result;
+}
+
+// Discard contents of freed mapping and add it to free list
+// Oldest free mappings are unmapped while free list holds more than FREE_MAPPING_BYTES
+static void KeepMapping(Mapping *mapping) {
+    // truncated pages are dropped without being written, extended file reads as zeros
+    if (ftruncate(mapping->file, 0) != 0 || ftruncate(mapping->file, (off_t) mapping->size) != 0) {
+        UnmapDigits(mapping);
+        return;
+    }
+
+    pthread_mutex_lock(&mappingsLock);
+
+    mapping->next = freeMappings;
+    freeMappings = mapping;
+    freeMappingBytes += mapping->size;
+
+    // removed mappings are unmapped without lock
+    Mapping *removed = NULL;
+    while (freeMappingBytes > FREE_MAPPING_BYTES && freeMappings->next != NULL) {
+        Mapping **last = &freeMappings;
+        while ((*last)->next != NULL) {
+            last = &(*last)->next;
+        }
+        (*last)->next = removed;
+        removed = *last;
+        *last = NULL;
+        freeMappingBytes -= removed->size;
+    }
+
+    pthread_mutex_unlock(&mappingsLock);
+
+    while (removed != NULL) {
+        Mapping *next = removed->next;
+        UnmapDigits(removed);
+        removed = next;
+    }
+}
+
+// Unmap digits and close temporary file, that is then deleted by the system
+static void UnmapDigits(Mapping *mapping) {
+    munmap(mapping->digits, mapping->size);
+    close(mapping->file);
+    BcProfileMapping(-(int64_t) mapping->size);
+    free(mapping);
+}
+
+// Return digit array of (size) bytes mapped to a new temporary file, NULL on failure
+static uint32_t *MapDigits(size_t size) {
+    size = (size + MAPPED_STORAGE_GRANULARITY - 1) / MAPPED_STORAGE_GRANULARITY * MAPPED_STORAGE_GRANULARITY;
+
+    char *fileName = malloc(strlen(storageDirectory) + 32);
+    sprintf(fileName, "%s/bigcalc-XXXXXX", storageDirectory);
+
+    int file = mkstemp(fileName);
+    if (file < 0) {
+        free(fileName);
+        return NULL;
+    }
+    unlink(fileName);
+    free(fileName);
+
+    if (ftruncate(file, (off_t) size) != 0) {
+        close(file);
+        return NULL;
+    }
+
+    void *digits = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (digits == MAP_FAILED) {
+        close(file);
+        return NULL;
+    }
+
+    // operations sweep digits from one end to the other : let the system read ahead and drop pages behind
+    posix_madvise(digits, size, POSIX_MADV_SEQUENTIAL);
+
+    Mapping *mapping = malloc(sizeof(Mapping));
+    mapping->digits = digits;
+    mapping->size = size;
+    mapping->file = file;
+
+    pthread_mutex_lock(&mappingsLock);
+    mapping->next = mappings;
+    mappings = mapping;
+    pthread_mutex_unlock(&mappingsLock);
+
+    BcProfileMapping((int64_t) size);
+
+    return digits;
+}